@@ -0,0 +1,1183 @@
+// Headless benchmark driver for the engine core (no Qt).
+//
+//   bench smp [depth] [maxThreads]
+//       Lazy SMP scaling: time-to-depth and nodes/sec for 1, 2, 4, ... threads.
+//   bench ordering [depth]
+//       Nodes to reach a fixed depth with and without move ordering, plus the
+//       effective branching factor nodes(depth) / nodes(depth - 1).
+//   bench tactics [maxDepth]
+//       Nodes needed to find the solution of each tactical test position with
+//       plain fixed-depth search, with quiescence, and with quiescence + SEE.
+//   bench pruning [movetimeMs]
+//       Depth reached in a fixed time per position with PVS, null-move
+//       pruning, late move reductions and check extensions toggled.
+//   bench draws [depth]
+//       Nodes to reach a fixed depth in shuffling endgames with and without
+//       repetition and fifty-move detection.
+//   bench movegen [resultFile] [baselineFile]
+//       ns/op (mean and standard deviation over samples) and TSC cycles/op of
+//       the move generator primitives, make/unmake and loadFEN. Results can
+//       be written to a file and compared against a saved one.
+//   bench kpk [depth]
+//       Builds the KPK bitbase, checks it against the brute-force solver and
+//       searches a few king and pawn endings with it.
+//   bench notation [games]
+//       Moves per second of SAN and UCI formatting and parsing over random
+//       games, against matching the text against every legal move.
+//   bench mate [maxNodes]
+//       Mate problems solved by proof-number search, with all attacking
+//       moves and with checks only, next to the alpha-beta search to the
+//       same depth.
+//   bench tablebase [material] [directory] [threads]
+//       Generates a tablebase and the smaller ones it needs, then reports
+//       the file sizes, the longest mate and the probe time.
+//   bench copymake [perftDepth] [searchDepth]
+//       Nodes per second of perft and of a plain alpha-beta search with
+//       make/unmake on board against copy-make on CompactBoard.
+//   bench nnue [perftDepth]
+//       Loads a network with random weights and walks perft trees with each
+//       accumulator kernel the CPU runs, checking the incremental accumulator
+//       against a full refresh after every make and unmake, and that every
+//       kernel gives the same evaluation at every node.
+
+#include "board.h"
+#include "movegenerator.h"
+#include "engine.h"
+#include "notation.h"
+#include "kpk.h"
+#include "tablebase.h"
+#include "matesolver.h"
+#include "compactboard.h"
+#include "evaluation.h"
+#include "nnue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BENCH_HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+static inline uint64_t readCycles() {
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static const char* BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "2r3k1/pp3ppp/4p3/3p4/3P4/2P1P3/PP3PPP/2R3K1 w - - 0 20",
+};
+
+static const int BENCH_POSITION_COUNT = sizeof(BENCH_POSITIONS) / sizeof(BENCH_POSITIONS[0]);
+
+// Win At Chess positions with their best move in UCI notation.
+struct TacticalPosition {
+    const char* fen;
+    const char* bestMove;
+};
+
+static const TacticalPosition TACTICAL_POSITIONS[] = {
+    { "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1", "g3g6" },
+    { "8/7p/5k2/5p2/p1p2P2/Pr1pPK2/1P1R3P/8 b - - 0 1", "b3b2" },
+    { "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1", "e3g3" },
+    { "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1", "h6h7" },
+    { "5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1", "c6c4" },
+    { "7k/p7/1R5K/6r1/6p1/6P1/8/8 w - - 0 1", "b6b7" },
+    { "r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1", "e7f7" },
+    { "3q1rk1/p4pp1/2pb3p/3p4/6Pr/1PNQ4/P1PB1PP1/4RRK1 b - - 0 1", "d6h2" },
+    { "2br2k1/2q3rn/p2NppQ1/2p1P3/Pp5R/4P3/1P3PPP/3R2K1 w - - 0 1", "h4h7" },
+};
+
+// Locked or drawn endgames where most lines just shuffle pieces around.
+static const char* SHUFFLE_POSITIONS[] = {
+    "8/8/1p1k4/1P6/2K5/8/8/8 w - - 0 1",
+    "8/5k2/8/3p1p2/3P1P2/8/4K3/8 w - - 0 1",
+    "8/8/4k3/3r4/8/3R4/4K3/8 w - - 0 1",
+    "6k1/6p1/8/8/8/8/5B2/6K1 w - - 0 1",
+    "8/3k4/8/2pP4/2P5/8/3K1B2/8 w - - 0 1",
+};
+
+// King and pawn against king, with the expected result for the side to move.
+static const struct {
+    const char* fen;
+    const char* result;
+} KPK_POSITIONS[] = {
+    { "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", "win" },      // king on the sixth
+    { "8/4k3/8/4K3/4P3/8/8/8 w - - 0 1", "draw" },     // black has the opposition
+    { "8/4k3/8/4K3/4P3/8/8/8 b - - 0 1", "loss" },
+    { "k7/8/8/8/8/8/P7/K7 w - - 0 1", "draw" },        // rook pawn, king in the corner
+    { "K7/8/8/8/8/4k3/4p3/8 w - - 0 1", "loss" },       // black pawn
+};
+
+static const int SHUFFLE_POSITION_COUNT = sizeof(SHUFFLE_POSITIONS) / sizeof(SHUFFLE_POSITIONS[0]);
+
+static const int TACTICAL_POSITION_COUNT = sizeof(TACTICAL_POSITIONS) / sizeof(TACTICAL_POSITIONS[0]);
+
+static int benchSmp(int depth, int maxThreads) {
+    printf("Lazy SMP scaling, depth %d, %d positions\n", depth, BENCH_POSITION_COUNT);
+    printf("%8s %12s %14s %12s %10s %10s\n",
+        "threads", "time(s)", "nodes", "knps", "ttd-x", "nps-x");
+
+    double baseTime = 0.0;
+    double baseNps = 0.0;
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        Engine engine;
+        engine.setThreads(threads);
+        engine.setHashSize(64);
+
+        double seconds = 0.0;
+        long long nodes = 0;
+
+        for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+            board b;
+            b.loadFEN(BENCH_POSITIONS[i]);
+            engine.clearHash();
+            engine.findBestMove(b, depth);
+            seconds += engine.lastSearch().seconds;
+            nodes += engine.lastSearch().nodes;
+        }
+
+        double nps = seconds > 0.0 ? nodes / seconds : 0.0;
+        if (threads == 1) {
+            baseTime = seconds;
+            baseNps = nps;
+        }
+
+        printf("%8d %12.3f %14lld %12.0f %10.2f %10.2f\n",
+            threads, seconds, nodes, nps / 1000.0,
+            seconds > 0.0 ? baseTime / seconds : 0.0,
+            baseNps > 0.0 ? nps / baseNps : 0.0);
+    }
+
+    return 0;
+}
+
+// Total nodes over the benchmark set for one engine configuration.
+static long long searchBenchSet(const EngineOptions& options, int depth, double& seconds) {
+    Engine engine;
+    engine.setOptions(options);
+
+    long long nodes = 0;
+    seconds = 0.0;
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        board b;
+        b.loadFEN(BENCH_POSITIONS[i]);
+        engine.clearHash();
+        engine.findBestMove(b, depth);
+        seconds += engine.lastSearch().seconds;
+        nodes += engine.lastSearch().nodes;
+    }
+
+    return nodes;
+}
+
+static int benchOrdering(int depth) {
+    printf("Move ordering, depth %d, %d positions\n", depth, BENCH_POSITION_COUNT);
+    printf("%-10s %14s %14s %10s %10s\n", "ordering", "nodes", "nodes(d-1)", "ebf", "time(s)");
+
+    for (int on = 0; on <= 1; ++on) {
+        EngineOptions options;
+        options.moveOrdering = (on != 0);
+
+        double seconds = 0.0, prevSeconds = 0.0;
+        long long nodes = searchBenchSet(options, depth, seconds);
+        long long prevNodes = searchBenchSet(options, depth - 1, prevSeconds);
+
+        printf("%-10s %14lld %14lld %10.2f %10.3f\n",
+            on ? "on" : "off", nodes, prevNodes,
+            prevNodes > 0 ? (double)nodes / prevNodes : 0.0, seconds);
+    }
+
+    return 0;
+}
+
+static int benchTactics(int maxDepth) {
+    struct Config {
+        const char* name;
+        bool quiescence;
+        bool seePruning;
+    };
+    static const Config CONFIGS[] = {
+        { "plain", false, false },
+        { "qsearch", true, false },
+        { "qsearch+see", true, true },
+    };
+
+    printf("Tactical suite, %d positions, up to depth %d\n", TACTICAL_POSITION_COUNT, maxDepth);
+    printf("%-12s %8s %14s %10s\n", "config", "solved", "nodes", "time(s)");
+
+    for (const Config& config : CONFIGS) {
+        EngineOptions options;
+        options.quiescence = config.quiescence;
+        options.seePruning = config.seePruning;
+
+        Engine engine;
+        engine.setOptions(options);
+
+        int solved = 0;
+        long long nodes = 0;
+        double seconds = 0.0;
+
+        // A position counts as solved at the first depth from which the
+        // solution stays the best move up to maxDepth. Its cost is the nodes
+        // of a fresh search to that depth; unsolved positions cost maxDepth.
+        for (const TacticalPosition& t : TACTICAL_POSITIONS) {
+            board b;
+            b.loadFEN(t.fen);
+
+            std::vector<long long> depthNodes(maxDepth + 1, 0);
+            std::vector<double> depthSeconds(maxDepth + 1, 0.0);
+            int solvedAt = -1;
+
+            for (int depth = 1; depth <= maxDepth; ++depth) {
+                engine.clearHash();
+                Move m = engine.findBestMove(b, depth);
+                depthNodes[depth] = engine.lastSearch().nodes;
+                depthSeconds[depth] = engine.lastSearch().seconds;
+
+                bool found = (moveToUci(m) == t.bestMove);
+                if (found && solvedAt < 0) solvedAt = depth;
+                if (!found) solvedAt = -1;
+            }
+
+            int costDepth = solvedAt > 0 ? solvedAt : maxDepth;
+            if (solvedAt > 0) ++solved;
+            nodes += depthNodes[costDepth];
+            seconds += depthSeconds[costDepth];
+        }
+
+        printf("%-12s %5d/%-2d %14lld %10.3f\n",
+            config.name, solved, TACTICAL_POSITION_COUNT, nodes, seconds);
+    }
+
+    return 0;
+}
+
+static int benchPruning(int movetimeMs) {
+    struct Config {
+        const char* name;
+        bool pvs;
+        bool nullMove;
+        bool lmr;
+        bool checkExtensions;
+    };
+    static const Config CONFIGS[] = {
+        { "none", false, false, false, false },
+        { "pvs", true, false, false, false },
+        { "null-move", false, true, false, false },
+        { "lmr", false, false, true, false },
+        { "check-ext", false, false, false, true },
+        { "all", true, true, true, true },
+    };
+
+    printf("Pruning, %d ms per position, %d positions\n", movetimeMs, BENCH_POSITION_COUNT);
+    printf("%-10s %10s %10s %14s %12s\n", "config", "avg depth", "min depth", "nodes", "knps");
+
+    for (const Config& config : CONFIGS) {
+        EngineOptions options;
+        options.pvs = config.pvs;
+        options.nullMove = config.nullMove;
+        options.lmr = config.lmr;
+        options.checkExtensions = config.checkExtensions;
+
+        Engine engine;
+        engine.setOptions(options);
+
+        SearchLimits limits;
+        limits.movetimeMs = movetimeMs;
+
+        int depthSum = 0;
+        int minDepth = Engine::MAX_PLY;
+        long long nodes = 0;
+        double seconds = 0.0;
+
+        for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+            board b;
+            b.loadFEN(BENCH_POSITIONS[i]);
+            engine.clearHash();
+            engine.go(b, limits);
+
+            int depth = engine.lastSearch().depth;
+            depthSum += depth;
+            if (depth < minDepth) minDepth = depth;
+            nodes += engine.lastSearch().nodes;
+            seconds += engine.lastSearch().seconds;
+        }
+
+        printf("%-10s %10.2f %10d %14lld %12.0f\n",
+            config.name, (double)depthSum / BENCH_POSITION_COUNT, minDepth, nodes,
+            seconds > 0.0 ? nodes / seconds / 1000.0 : 0.0);
+    }
+
+    return 0;
+}
+
+static int benchDraws(int depth) {
+    printf("Draw detection, depth %d, %d positions\n", depth, SHUFFLE_POSITION_COUNT);
+    printf("%-10s %14s %10s\n", "draws", "nodes", "time(s)");
+
+    for (int on = 0; on <= 1; ++on) {
+        EngineOptions options;
+        options.drawDetection = (on != 0);
+
+        Engine engine;
+        engine.setOptions(options);
+
+        long long nodes = 0;
+        double seconds = 0.0;
+
+        for (const char* fen : SHUFFLE_POSITIONS) {
+            board b;
+            b.loadFEN(fen);
+            engine.clearHash();
+            engine.findBestMove(b, depth);
+            nodes += engine.lastSearch().nodes;
+            seconds += engine.lastSearch().seconds;
+        }
+
+        printf("%-10s %14lld %10.3f\n", on ? "on" : "off", nodes, seconds);
+    }
+
+    return 0;
+}
+
+static int benchKpk(int depth) {
+    auto start = std::chrono::steady_clock::now();
+    Kpk::init();
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    int mismatches = Kpk::verify();
+    double verifySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("KPK bitbase: %zu bytes, built in %.3f s\n", Kpk::tableBytes(), buildSeconds);
+    printf("brute-force check: %d mismatches in %.3f s\n\n", mismatches, verifySeconds);
+
+    printf("Search to depth %d\n", depth);
+    printf("%-36s %-6s %8s %8s %12s\n", "position", "expect", "move", "score", "nodes");
+
+    Engine engine;
+    int wrong = mismatches;
+    for (const auto& p : KPK_POSITIONS) {
+        board b;
+        b.loadFEN(p.fen);
+        engine.clearHash();
+        Move best = engine.findBestMove(b, depth);
+        int score = engine.lastSearch().score;
+
+        // bare kings still get piece-square scores, so a draw is only near 0
+        const char* got = score > 5000 ? "win" : score < -5000 ? "loss" : "draw";
+        if (std::strcmp(got, p.result) != 0) ++wrong;
+        printf("%-36s %-6s %8s %8d %12lld\n", p.fen, p.result, moveToUci(best).c_str(),
+            score, engine.lastSearch().nodes);
+    }
+
+    return wrong == 0 ? 0 : 1;
+}
+
+// ---- Notation ----
+
+static int benchNotation(int gameCount) {
+    // random games from the start position, replayed for every timing
+    struct Game {
+        std::vector<Move> moves;
+        std::vector<std::string> san, uci;
+    };
+    std::vector<Game> games(gameCount);
+    std::mt19937 rng(1);
+    MoveGenerator generator;
+    size_t totalMoves = 0;
+
+    for (Game& game : games) {
+        board b;
+        b.loadFEN(BENCH_POSITIONS[0]);
+        for (int ply = 0; ply < 120; ++ply) {
+            std::vector<Move> legal = generator.generateLegalMoves(b);
+            if (legal.empty()) break;
+            Move m = legal[rng() % legal.size()];
+            game.moves.push_back(m);
+            game.san.push_back(moveToSan(b, generator, m));
+            game.uci.push_back(moveToUci(m));
+            b.makeMove(m);
+        }
+        totalMoves += game.moves.size();
+    }
+
+    // replays every game, calling step(board, game, ply) before each move;
+    // false from step is a failure
+    auto replay = [&](const char* name, auto step) {
+        auto start = std::chrono::steady_clock::now();
+        int failures = 0;
+        for (const Game& game : games) {
+            board b;
+            b.loadFEN(BENCH_POSITIONS[0]);
+            for (size_t ply = 0; ply < game.moves.size(); ++ply) {
+                if (!step(b, game, ply)) ++failures;
+                b.makeMove(game.moves[ply]);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %12.0f moves/s %9.1f ns/move %s\n", name, totalMoves / seconds,
+            seconds * 1e9 / totalMoves, failures ? "FAILED" : "");
+        return failures;
+    };
+
+    auto same = [](const Move& a, const Move& b) {
+        return a.from == b.from && a.to == b.to && a.wasPromotion == b.wasPromotion
+            && (!a.wasPromotion || a.promotedTo == b.promotedTo);
+    };
+
+    printf("Notation, %d random games, %zu moves\n", gameCount, totalMoves);
+    int failures = 0;
+    failures += replay("make only", [&](board&, const Game&, size_t) { return true; });
+    failures += replay("moveToSan", [&](board& b, const Game& g, size_t ply) {
+        return moveToSan(b, generator, g.moves[ply]) == g.san[ply];
+    });
+    failures += replay("parseSanMove", [&](board& b, const Game& g, size_t ply) {
+        Move m;
+        return parseSanMove(b, generator, g.san[ply], m) && same(m, g.moves[ply]);
+    });
+    failures += replay("parseUciMove", [&](board& b, const Game& g, size_t ply) {
+        Move m;
+        return parseUciMove(b, generator, g.uci[ply], m) && same(m, g.moves[ply]);
+    });
+    failures += replay("legal moves + SAN compare", [&](board& b, const Game& g, size_t ply) {
+        for (const Move& m : generator.generateLegalMoves(b)) {
+            if (moveToSan(b, generator, m) == g.san[ply]) return same(m, g.moves[ply]);
+        }
+        return false;
+    });
+
+    return failures == 0 ? 0 : 1;
+}
+
+// ---- Mate solver ----
+
+struct MatePosition {
+    const char* fen;
+    int moves;          // mate in
+};
+
+static const MatePosition MATE_POSITIONS[] = {
+    { "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1 },
+    { "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 1 },
+    { "kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2 },
+    { "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0", 2 },
+    { "6k1/pp4p1/2p5/2bp4/8/P5Pb/1P3rrP/2BRRN1K b - - 0 1", 2 },
+    { "r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1", 3 },
+    { "1r5k/6pp/8/4N3/2Q5/8/8/6K1 w - - 0 1", 4 },
+    { "8/8/8/3k4/8/8/8/KQ6 w - - 0 1", 9 },
+};
+
+static int benchMate(long long maxNodes) {
+    printf("Mate problems, proof-number search up to %lld nodes\n", maxNodes);
+    printf("%-66s %4s %-8s %10s %9s %-8s %10s %9s %12s %9s\n", "position", "mate", "pns", "nodes", "time(s)",
+        "checks", "nodes", "time(s)", "alphabeta", "time(s)");
+
+    MateSolver solver;
+    Engine engine;
+    int wrong = 0;
+    for (const MatePosition& p : MATE_POSITIONS) {
+        board b;
+        b.loadFEN(p.fen);
+
+        MateResult all = solver.solve(b, p.moves, false, maxNodes);
+        MateResult checks = solver.solve(b, p.moves, true, maxNodes);
+
+        // plain search needs the full depth to see the mate
+        engine.clearHash();
+        engine.findBestMove(b, 2 * p.moves - 1);
+        const SearchStats& s = engine.lastSearch();
+        bool searchFound = s.score > Engine::MATE_BOUND;
+
+        auto status = [](const MateResult& r) {
+            return r.status == MateResult::MATE ? "mate " + std::to_string((r.plies + 1) / 2)
+                : r.status == MateResult::NO_MATE ? std::string("none") : std::string("unknown");
+        };
+        if (all.status != MateResult::MATE || (all.plies + 1) / 2 > p.moves) ++wrong;
+
+        printf("%-66s %4d %-8s %10lld %9.3f %-8s %10lld %9.3f %12lld %9.3f%s\n", p.fen, p.moves,
+            status(all).c_str(), all.nodes, all.seconds, status(checks).c_str(), checks.nodes, checks.seconds,
+            s.nodes, s.seconds, searchFound ? "" : " (no mate)");
+
+        printf("    ");
+        for (const Move& m : all.line) printf(" %s", moveToUci(m).c_str());
+        printf("\n");
+    }
+
+    return wrong == 0 ? 0 : 1;
+}
+
+// ---- Tablebases ----
+
+static int benchTablebase(const std::string& material, const std::string& directory, int threads) {
+    if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!Tablebase::generate(material, directory, threads, error)) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%s and its dependencies ready in %.2f s (%d threads)\n\n", material.c_str(), seconds, threads);
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == ".cmgtb") {
+            printf("%-16s %12llu bytes\n", entry.path().filename().string().c_str(),
+                (unsigned long long)entry.file_size());
+        }
+    }
+
+    // random placements of the material, the side to move not giving check
+    const char* letters = "QRBNP";
+    const Piece white[] = { WQ, WR, WB, WN, WP };
+    const Piece black[] = { BQ, BR, BB, BN, BP };
+    std::vector<Piece> pieces = { WK, BK };
+    size_t second = material.find('K', 1);
+    for (size_t i = 1; i < material.size(); ++i) {
+        if (i == second) continue;
+        int k = (int)(std::strchr(letters, material[i]) - letters);
+        pieces.push_back(i < second ? white[k] : black[k]);
+    }
+
+    std::mt19937 rng(1);
+    MoveGenerator generator;
+    std::vector<board> boards;
+    while (boards.size() < 100000) {
+        int squares[Tablebase::MAX_PIECES];
+        bool ok = true;
+        for (size_t i = 0; i < pieces.size() && ok; ++i) {
+            squares[i] = (int)(rng() % 64);
+            bool pawn = pieces[i] == WP || pieces[i] == BP;
+            if (pawn && (squares[i] < 8 || squares[i] >= 56)) ok = false;
+            for (size_t j = 0; j < i; ++j) {
+                if (squares[j] == squares[i]) ok = false;
+            }
+        }
+        if (!ok) continue;
+
+        board b;
+        bool whiteToMove = rng() & 1;
+        b.setPosition(pieces.data(), squares, (int)pieces.size(), whiteToMove);
+        if (generator.isSquareAttacked(b, squares[whiteToMove ? 1 : 0], whiteToMove)) continue;
+        boards.push_back(b);
+    }
+
+    int wins = 0, draws = 0, longest = 0;
+    start = std::chrono::steady_clock::now();
+    for (const board& b : boards) {
+        Tablebase::ProbeResult r;
+        if (!Tablebase::probe(b, r)) {
+            printf("probe failed\n");
+            return 1;
+        }
+        if (r.wdl == Tablebase::WIN) ++wins;
+        if (r.wdl == Tablebase::DRAW) ++draws;
+        if (r.plies > longest) longest = r.plies;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("\n%zu random positions: %d won, %d drawn, %zu lost by the side to move\n",
+        boards.size(), wins, draws, boards.size() - wins - draws);
+    printf("longest mate seen: %d plies\n", longest);
+    printf("probe: %.1f ns\n", ns / boards.size());
+    return 0;
+}
+
+// ---- Copy-make ----
+
+// The same perft and alpha-beta written once per scheme: make/unmake on a
+// board, or copy-make on a CompactBoard. The search has no table, no
+// quiescence and captures-first ordering only, so the time goes to move
+// generation and position updates; both evaluate material + piece-square.
+static constexpr int COPY_MAKE_MATE = 30000;
+
+static int taperedScore(const board& b) {
+    int phase = std::min(b.gamePhase, PHASE_MAX);
+    int mg = b.mgScore[1] - b.mgScore[0];
+    int eg = b.egScore[1] - b.egScore[0];
+    int score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+    return b.isWhiteTurn ? score : -score;
+}
+
+static void capturesFirst(std::vector<Move>& moves) {
+    std::stable_partition(moves.begin(), moves.end(), [](const Move& m) { return m.captured != EMPTY; });
+}
+
+struct MakeUnmakeKernel {
+    MoveGenerator generator;
+    std::vector<Move> moves[64];
+    long long nodes = 0;
+
+    long long perft(board& b, int depth, int ply = 0) {
+        generator.generateLegalMoves(b, moves[ply]);
+        if (depth == 1) return (long long)moves[ply].size();
+        long long n = 0;
+        for (const Move& m : moves[ply]) {
+            Unmove u = b.makeMove(m);
+            n += perft(b, depth - 1, ply + 1);
+            b.unmakeMove(m, u);
+        }
+        return n;
+    }
+
+    int search(board& b, int depth, int alpha, int beta, int ply = 0) {
+        ++nodes;
+        if (depth == 0) return taperedScore(b);
+        std::vector<Move>& list = moves[ply];
+        generator.generateLegalMoves(b, list);
+        if (list.empty()) {
+            int king = generator.findKing(b, b.isWhiteTurn);
+            return generator.isSquareAttacked(b, king, !b.isWhiteTurn) ? -COPY_MAKE_MATE + ply : 0;
+        }
+        capturesFirst(list);
+        for (const Move& m : list) {
+            Unmove u = b.makeMove(m);
+            int score = -search(b, depth - 1, -beta, -alpha, ply + 1);
+            b.unmakeMove(m, u);
+            if (score >= beta) return score;
+            alpha = std::max(alpha, score);
+        }
+        return alpha;
+    }
+};
+
+struct CopyMakeKernel {
+    MoveGenerator generator;
+    std::vector<Move> moves[64];
+    long long nodes = 0;
+
+    long long perft(const CompactBoard& b, int depth, int ply = 0) {
+        generator.generateLegalMoves(b, moves[ply]);
+        if (depth == 1) return (long long)moves[ply].size();
+        long long n = 0;
+        for (const Move& m : moves[ply]) {
+            n += perft(b.play(m), depth - 1, ply + 1);
+        }
+        return n;
+    }
+
+    int search(const CompactBoard& b, int depth, int alpha, int beta, int ply = 0) {
+        ++nodes;
+        if (depth == 0) return b.evaluate();
+        std::vector<Move>& list = moves[ply];
+        generator.generateLegalMoves(b, list);
+        if (list.empty()) {
+            int king = generator.findKing(b, b.isWhiteTurn);
+            return generator.isSquareAttacked(b, king, !b.isWhiteTurn) ? -COPY_MAKE_MATE + ply : 0;
+        }
+        capturesFirst(list);
+        for (const Move& m : list) {
+            int score = -search(b.play(m), depth - 1, -beta, -alpha, ply + 1);
+            if (score >= beta) return score;
+            alpha = std::max(alpha, score);
+        }
+        return alpha;
+    }
+};
+
+static int benchCopyMake(int perftDepth, int searchDepth) {
+    printf("Copy-make vs make/unmake: board %zu bytes + Unmove %zu bytes, CompactBoard %zu bytes\n",
+        sizeof(board), sizeof(Unmove), sizeof(CompactBoard));
+    printf("%-4s %-10s %12s %14s %14s %8s\n", "pos", "workload", "nodes", "make/unmake", "copy-make", "ratio");
+
+    int failures = 0;
+    double totalSeconds[2][2] = {};
+    long long totalNodes[2] = {};
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        board b;
+        b.loadFEN(BENCH_POSITIONS[i]);
+        CompactBoard compact(b);
+
+        for (int workload = 0; workload < 2; ++workload) {
+            MakeUnmakeKernel makeUnmake;
+            CopyMakeKernel copyMake;
+            long long nodes[2] = {};
+            double seconds[2];
+
+            auto start = std::chrono::steady_clock::now();
+            int scores[2] = {};
+            if (workload == 0) nodes[0] = makeUnmake.perft(b, perftDepth);
+            else scores[0] = makeUnmake.search(b, searchDepth, -COPY_MAKE_MATE - 1, COPY_MAKE_MATE + 1);
+            seconds[0] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            if (workload == 0) nodes[1] = copyMake.perft(compact, perftDepth);
+            else scores[1] = copyMake.search(compact, searchDepth, -COPY_MAKE_MATE - 1, COPY_MAKE_MATE + 1);
+            seconds[1] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (workload == 1) {
+                nodes[0] = makeUnmake.nodes;
+                nodes[1] = copyMake.nodes;
+            }
+            bool same = nodes[0] == nodes[1] && scores[0] == scores[1];
+            if (!same) ++failures;
+
+            for (int scheme = 0; scheme < 2; ++scheme) totalSeconds[workload][scheme] += seconds[scheme];
+            totalNodes[workload] += nodes[0];
+
+            char name[32];
+            snprintf(name, sizeof(name), workload == 0 ? "perft %d" : "search %d", workload == 0 ? perftDepth : searchDepth);
+            printf("%-4d %-10s %12lld %9.2f Mn/s %9.2f Mn/s %7.2fx %s\n", i + 1, name, nodes[0],
+                nodes[0] / seconds[0] / 1e6, nodes[1] / seconds[1] / 1e6, seconds[0] / seconds[1],
+                same ? "" : "MISMATCH");
+        }
+    }
+
+    for (int workload = 0; workload < 2; ++workload) {
+        printf("%-4s %-10s %12lld %9.2f Mn/s %9.2f Mn/s %7.2fx\n", "all", workload == 0 ? "perft" : "search",
+            totalNodes[workload], totalNodes[workload] / totalSeconds[workload][0] / 1e6,
+            totalNodes[workload] / totalSeconds[workload][1] / 1e6,
+            totalSeconds[workload][0] / totalSeconds[workload][1]);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// ---- Movegen microbenchmarks ----
+
+struct MicroResult {
+    std::string name;
+    double nsPerOp = 0.0;
+    double stddev = 0.0;        // of nsPerOp over the samples
+    double cyclesPerOp = 0.0;   // 0 where no cycle counter is available
+};
+
+static constexpr int MICRO_SAMPLES = 15;
+static constexpr double MICRO_SAMPLE_SECONDS = 0.02;
+
+// Keeps results alive so the timed calls aren't optimised away. Updated as
+// microSink = microSink + x: compound assignment to a volatile is
+// deprecated in C++20.
+static volatile long long microSink = 0;
+
+// batch() runs one pass over the position set and returns how many
+// operations it performed.
+template <typename Batch>
+static MicroResult measure(const char* name, Batch batch) {
+    using clock = std::chrono::steady_clock;
+
+    // calibrate: enough passes per sample to run for MICRO_SAMPLE_SECONDS
+    int passes = 1;
+    for (;;) {
+        auto start = clock::now();
+        for (int i = 0; i < passes; ++i) batch();
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        if (seconds >= MICRO_SAMPLE_SECONDS || passes >= (1 << 24)) break;
+        passes *= 2;
+    }
+
+    std::vector<double> samples;
+    double cycleSum = 0.0;
+    long long opSum = 0;
+
+    for (int s = 0; s < MICRO_SAMPLES; ++s) {
+        long long ops = 0;
+        auto start = clock::now();
+        uint64_t cycles = readCycles();
+        for (int i = 0; i < passes; ++i) ops += batch();
+        cycles = readCycles() - cycles;
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+        samples.push_back(ns / ops);
+        cycleSum += (double)cycles;
+        opSum += ops;
+    }
+
+    MicroResult r;
+    r.name = name;
+    for (double x : samples) r.nsPerOp += x;
+    r.nsPerOp /= samples.size();
+    for (double x : samples) r.stddev += (x - r.nsPerOp) * (x - r.nsPerOp);
+    r.stddev = std::sqrt(r.stddev / (samples.size() - 1));
+    r.cyclesPerOp = cycleSum / opSum;
+    return r;
+}
+
+// False if the file can't be read or holds no results.
+static bool readMicroResults(const char* path, std::vector<MicroResult>& results) {
+    results.clear();
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    char name[128];
+    MicroResult r;
+    while (fscanf(f, "%127s %lf %lf %lf", name, &r.nsPerOp, &r.stddev, &r.cyclesPerOp) == 4) {
+        r.name = name;
+        results.push_back(r);
+    }
+    fclose(f);
+    return !results.empty();
+}
+
+static int benchMovegen(const char* resultFile, const char* baselineFile) {
+    // a baseline that can't be read must not pass a regression check
+    std::vector<MicroResult> baseline;
+    if (baselineFile && !readMicroResults(baselineFile, baseline)) {
+        printf("cannot read baseline %s\n", baselineFile);
+        return 1;
+    }
+
+    std::vector<board> boards(BENCH_POSITION_COUNT);
+    for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+        boards[i].loadFEN(BENCH_POSITIONS[i]);
+    }
+
+    MoveGenerator generator;
+    std::vector<std::vector<Move>> legal;
+    for (board& b : boards) {
+        legal.push_back(generator.generateLegalMoves(b));
+    }
+
+    std::vector<MicroResult> results;
+    std::vector<Move> scratch;
+    scratch.reserve(256);
+
+    results.push_back(measure("generatePseudoLegalMoves", [&]() {
+        long long ops = 0;
+        for (board& b : boards) {
+            microSink = microSink + generator.generatePseudoLegalMoves(b).size();
+            ++ops;
+        }
+        return ops;
+    }));
+    results.push_back(measure("generateLegalMoves", [&]() {
+        long long ops = 0;
+        for (board& b : boards) {
+            microSink = microSink + generator.generateLegalMoves(b).size();
+            ++ops;
+        }
+        return ops;
+    }));
+
+    // one helper call per piece of the side to move that the helper handles
+    struct Helper {
+        const char* name;
+        bool (*accepts)(Piece);
+        void (*generate)(MoveGenerator&, board&, int, Piece, std::vector<Move>&);
+    };
+    static const Helper HELPERS[] = {
+        { "generatePawnMoves", [](Piece p) { return p == WP || p == BP; },
+            [](MoveGenerator& g, board& b, int sq, Piece p, std::vector<Move>& m) { g.generatePawnMoves(b, sq, p, m); } },
+        { "generateKnightMoves", [](Piece p) { return p == WN || p == BN; },
+            [](MoveGenerator& g, board& b, int sq, Piece p, std::vector<Move>& m) { g.generateKnightMoves(b, sq, p, m); } },
+        { "generateSlidingMoves", [](Piece p) { return p == WB || p == BB || p == WR || p == BR || p == WQ || p == BQ; },
+            [](MoveGenerator& g, board& b, int sq, Piece p, std::vector<Move>& m) { g.generateSlidingMoves(b, sq, p, m); } },
+        { "generateKingMoves", [](Piece p) { return p == WK || p == BK; },
+            [](MoveGenerator& g, board& b, int sq, Piece p, std::vector<Move>& m) { g.generateKingMoves(b, sq, p, m); } },
+        { "generateCastlingMoves", [](Piece p) { return p == WK || p == BK; },
+            [](MoveGenerator& g, board& b, int sq, Piece p, std::vector<Move>& m) { g.generateCastlingMoves(b, sq, p, m); } },
+    };
+    for (const Helper& h : HELPERS) {
+        results.push_back(measure(h.name, [&]() {
+            long long ops = 0;
+            for (board& b : boards) {
+                for (int sq = 0; sq < 64; ++sq) {
+                    Piece p = b.currentState[sq];
+                    if (!h.accepts(p) || (p >= WQ) != b.isWhiteTurn) continue;
+                    scratch.clear();
+                    h.generate(generator, b, sq, p, scratch);
+                    microSink = microSink + scratch.size();
+                    ++ops;
+                }
+            }
+            return ops;
+        }));
+    }
+
+    results.push_back(measure("isSquareAttacked", [&]() {
+        long long ops = 0;
+        for (board& b : boards) {
+            for (int sq = 0; sq < 64; ++sq) {
+                microSink = microSink + generator.isSquareAttacked(b, sq, true);
+                microSink = microSink + generator.isSquareAttacked(b, sq, false);
+                ops += 2;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("canCaptureKing", [&]() {
+        long long ops = 0;
+        for (board& b : boards) {
+            microSink = microSink + generator.canCaptureKing(b);
+            ++ops;
+        }
+        return ops;
+    }));
+    results.push_back(measure("makeMove+unmakeMove", [&]() {
+        long long ops = 0;
+        for (size_t i = 0; i < boards.size(); ++i) {
+            for (const Move& m : legal[i]) {
+                Unmove u = boards[i].makeMove(m);
+                microSink = microSink + (boards[i].zobristKey & 1);
+                boards[i].unmakeMove(m, u);
+                ++ops;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("loadFEN", [&]() {
+        long long ops = 0;
+        board b;
+        for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+            b.loadFEN(BENCH_POSITIONS[i]);
+            microSink = microSink + (b.zobristKey & 1);
+            ++ops;
+        }
+        return ops;
+    }));
+
+    // ---- Report ----
+    printf("Movegen primitives, %d positions, %d samples\n", BENCH_POSITION_COUNT, MICRO_SAMPLES);
+    printf("%-26s %10s %9s %11s", "primitive", "ns/op", "stddev", "cycles/op");
+    if (!baseline.empty()) printf(" %10s %8s", "base ns", "change");
+    printf("\n");
+
+    for (const MicroResult& r : results) {
+        printf("%-26s %10.2f %9.2f %11.1f", r.name.c_str(), r.nsPerOp, r.stddev, r.cyclesPerOp);
+
+        for (const MicroResult& b : baseline) {
+            if (b.name != r.name) continue;
+            double change = (r.nsPerOp - b.nsPerOp) / b.nsPerOp * 100.0;
+            // only call it a change if it is outside both runs' noise
+            bool significant = std::fabs(r.nsPerOp - b.nsPerOp) > 2.0 * (r.stddev + b.stddev);
+            printf(" %10.2f %+7.1f%%%s", b.nsPerOp, change, significant ? (change < 0 ? " faster" : " slower") : "");
+        }
+        printf("\n");
+    }
+
+    if (resultFile) {
+        FILE* f = fopen(resultFile, "w");
+        if (!f) {
+            printf("cannot write %s\n", resultFile);
+            return 1;
+        }
+        // one primitive per line: name ns/op stddev cycles/op
+        for (const MicroResult& r : results) {
+            fprintf(f, "%s %.3f %.3f %.1f\n", r.name.c_str(), r.nsPerOp, r.stddev, r.cyclesPerOp);
+        }
+        fclose(f);
+    }
+
+    return 0;
+}
+
+// ---- NNUE ----
+
+// A weights file in the layout nnue.h describes, filled with random values
+// wide enough that the clipped ReLU cuts off at both ends.
+static bool writeRandomNetwork(const std::string& path) {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> data(Nnue::HEADER_SIZE, 0);
+    std::memcpy(data.data(), "CMGNNUE1", 8);
+    uint32_t hidden = Nnue::HIDDEN;
+    std::memcpy(data.data() + 8, &hidden, sizeof(hidden));
+
+    auto append = [&](const void* p, size_t bytes) {
+        data.insert(data.end(), (const uint8_t*)p, (const uint8_t*)p + bytes);
+    };
+    for (int i = 0; i < Nnue::HIDDEN; ++i) {
+        int16_t bias = (int16_t)(rng() % 64);
+        append(&bias, sizeof(bias));
+    }
+    for (int i = 0; i < Nnue::INPUTS * Nnue::HIDDEN; ++i) {
+        int16_t weight = (int16_t)((int)(rng() % 41) - 20);
+        append(&weight, sizeof(weight));
+    }
+    for (int i = 0; i < 2 * Nnue::HIDDEN; ++i) {
+        int8_t weight = (int8_t)((int)(rng() % 256) - 128);
+        append(&weight, sizeof(weight));
+    }
+    int32_t outputBias = 1234;
+    append(&outputBias, sizeof(outputBias));
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+struct NnueWalk {
+    MoveGenerator generator;
+    std::vector<Move> moves[64];
+    std::vector<int> evals;         // one per node
+    bool verify = true;
+    long long stale = 0;            // make/unmakes after which the accumulator differs from a refresh
+    long long sum = 0;
+
+    void run(board& b, int depth, int ply = 0) {
+        int eval = Nnue::evaluate(b.accumulator, b.isWhiteTurn);
+        if (verify) evals.push_back(eval);
+        sum += eval;
+        if (depth == 0) return;
+
+        generator.generateLegalMoves(b, moves[ply]);
+        for (const Move& m : moves[ply]) {
+            Unmove u = b.makeMove(m);
+            if (verify && !b.verifyEval()) ++stale;
+            run(b, depth - 1, ply + 1);
+            b.unmakeMove(m, u);
+            if (verify && !b.verifyEval()) ++stale;
+        }
+    }
+};
+
+static int benchNnue(int perftDepth) {
+    std::string path = (std::filesystem::temp_directory_path() / "bench-random.nnue").string();
+    if (!writeRandomNetwork(path) || !Nnue::load(path)) {
+        printf("cannot write and load %s\n", path.c_str());
+        return 1;
+    }
+    std::string startKernel = Nnue::kernelName();
+
+    printf("NNUE kernels over perft %d trees, random network\n", perftDepth);
+    printf("%-8s %12s %12s %14s\n", "kernel", "nodes", "stale", "nodes/s");
+
+    int failures = 0;
+    std::vector<int> reference;
+    for (const char* kernel : { "scalar", "avx2" }) {
+        if (!Nnue::selectKernel(kernel)) {
+            printf("%-8s not supported by this CPU\n", kernel);
+            continue;
+        }
+
+        // one pass with the checks, then a timed one without them
+        NnueWalk walk;
+        double seconds = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            walk.verify = pass == 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BENCH_POSITION_COUNT; ++i) {
+                board b;
+                b.loadFEN(BENCH_POSITIONS[i]);
+                walk.run(b, perftDepth);
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        microSink = microSink + walk.sum;
+
+        const char* verdict = "";
+        if (reference.empty()) {
+            reference = walk.evals;
+        }
+        else if (walk.evals != reference) {
+            verdict = "EVAL MISMATCH";
+            ++failures;
+        }
+        if (walk.stale > 0) ++failures;
+        printf("%-8s %12zu %12lld %14.0f %s\n", kernel, walk.evals.size(), walk.stale, walk.evals.size() / seconds, verdict);
+    }
+
+    Nnue::selectKernel(startKernel);
+    Nnue::unload();
+    std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
+
+static void usage() {
+    printf("usage: bench smp [depth] [maxThreads]\n");
+    printf("       bench ordering [depth]\n");
+    printf("       bench tactics [maxDepth]\n");
+    printf("       bench pruning [movetimeMs]\n");
+    printf("       bench draws [depth]\n");
+    printf("       bench movegen [resultFile] [baselineFile]\n");
+    printf("       bench kpk [depth]\n");
+    printf("       bench notation [games]\n");
+    printf("       bench mate [maxNodes]\n");
+    printf("       bench tablebase [material] [directory] [threads]\n");
+    printf("       bench copymake [perftDepth] [searchDepth]\n");
+    printf("       bench nnue [perftDepth]\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    std::string suite = argv[1];
+
+    if (suite == "smp") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : 5;
+        int maxThreads = argc > 3 ? std::atoi(argv[3]) : 64;
+        return benchSmp(depth, maxThreads);
+    }
+    if (suite == "ordering") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : 5;
+        if (depth < 2) depth = 2;
+        return benchOrdering(depth);
+    }
+    if (suite == "tactics") {
+        int maxDepth = argc > 2 ? std::atoi(argv[2]) : 6;
+        return benchTactics(maxDepth);
+    }
+    if (suite == "pruning") {
+        int movetimeMs = argc > 2 ? std::atoi(argv[2]) : 1000;
+        return benchPruning(movetimeMs);
+    }
+    if (suite == "draws") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : 12;
+        return benchDraws(depth);
+    }
+    if (suite == "movegen") {
+        return benchMovegen(argc > 2 ? argv[2] : nullptr, argc > 3 ? argv[3] : nullptr);
+    }
+
+    if (suite == "kpk") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : 8;
+        return benchKpk(depth);
+    }
+    if (suite == "notation") {
+        int games = argc > 2 ? std::atoi(argv[2]) : 2000;
+        return benchNotation(games);
+    }
+    if (suite == "mate") {
+        long long maxNodes = argc > 2 ? std::atoll(argv[2]) : 10000000;
+        return benchMate(maxNodes);
+    }
+    if (suite == "tablebase") {
+        std::string material = argc > 2 ? argv[2] : "KBNK";
+        std::string directory = argc > 3 ? argv[3] : "tablebases";
+        int threads = argc > 4 ? std::atoi(argv[4]) : 0;
+        return benchTablebase(material, directory, threads);
+    }
+    if (suite == "copymake") {
+        int perftDepth = argc > 2 ? std::atoi(argv[2]) : 4;
+        int searchDepth = argc > 3 ? std::atoi(argv[3]) : 5;
+        return benchCopyMake(std::max(1, perftDepth), std::max(1, searchDepth));
+    }
+    if (suite == "nnue") {
+        int perftDepth = argc > 2 ? std::atoi(argv[2]) : 3;
+        return benchNnue(std::max(0, perftDepth));
+    }
+
+    usage();
+    return 1;
+}
@@ -0,0 +1,29 @@
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the least significant set bit. b must be non-zero.
+inline int lsbIndex(uint64_t b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return (int)index;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int popCount(uint64_t b) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(b);
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+#endif // BITOPS_H
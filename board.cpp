@@ -1,4 +1,13 @@
 #include "board.h"
+#include "zobrist.h"
+#include "psqt.h"
+#include "instrument.h"
+
+#include <cstring>
+
+#ifdef BOARD_VERIFY_EVAL
+#include <cassert>
+#endif
 
 board::board() {
     resetBoard();
@@ -10,7 +19,8 @@ void board::resetBoard() {
     hasEnPassant = false;
     enPassantSquare = -1;
     halfmoveClock = 0;
-    fullmoveNumber = 0;
+    fullmoveNumber = 1;
+    keyHistory.clear();
 
     Piece init[64] = { BR, BN, BB, BQ, BK, BB, BN, BR,
                    BP, BP, BP, BP, BP, BP, BP, BP,
@@ -25,8 +35,91 @@ void board::resetBoard() {
         currentState[i] = init[i];
     }
 
+    zobristKey = Zobrist::compute(*this);
+    recomputeEval();
+}
+
+void board::setPosition(const Piece* pieces, const int* squares, int count, bool whiteToMove) {
+    for (int i = 0; i < 64; i++) {
+        currentState[i] = EMPTY;
+    }
+    for (int i = 0; i < count; i++) {
+        currentState[squares[i]] = pieces[i];
+    }
+
+    isWhiteTurn = whiteToMove;
+    castleRights = 0;
+    hasEnPassant = false;
+    enPassantSquare = -1;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    keyHistory.clear();
+
+    zobristKey = Zobrist::compute(*this);
+    recomputeEval();
+}
+
+inline void board::evalAdd(Piece p, int sq) {
+    int side = (p >= WQ);
+    mgScore[side] += PSQT.mg[p][sq];
+    egScore[side] += PSQT.eg[p][sq];
+    material[side] += PSQT.material[p];
+    gamePhase += PSQT.phase[p];
+    pieceCount[p]++;
 }
+
+inline void board::evalRemove(Piece p, int sq) {
+    int side = (p >= WQ);
+    mgScore[side] -= PSQT.mg[p][sq];
+    egScore[side] -= PSQT.eg[p][sq];
+    material[side] -= PSQT.material[p];
+    gamePhase -= PSQT.phase[p];
+    pieceCount[p]--;
+}
+
+void board::recomputeEval() {
+    for (int side = 0; side < 2; ++side) {
+        mgScore[side] = 0;
+        egScore[side] = 0;
+        material[side] = 0;
+    }
+    gamePhase = 0;
+    for (int p = 0; p < 13; ++p) {
+        pieceCount[p] = 0;
+    }
+
+    for (int sq = 0; sq < 64; ++sq) {
+        evalAdd(currentState[sq], sq);  // EMPTY rows are all zero
+    }
+
+    if (Nnue::active()) {
+        Nnue::clear(accumulator);
+        for (int sq = 0; sq < 64; ++sq) {
+            Nnue::addPiece(accumulator, currentState[sq], sq);
+        }
+    }
+}
+
+bool board::verifyEval() const {
+    board fresh = *this;
+    fresh.recomputeEval();
+
+    for (int side = 0; side < 2; ++side) {
+        if (fresh.mgScore[side] != mgScore[side]) return false;
+        if (fresh.egScore[side] != egScore[side]) return false;
+        if (fresh.material[side] != material[side]) return false;
+    }
+    for (int p = BQ; p <= WB; ++p) {
+        if (fresh.pieceCount[p] != pieceCount[p]) return false;
+    }
+    if (Nnue::active() && std::memcmp(&fresh.accumulator, &accumulator, sizeof(accumulator)) != 0) {
+        return false;
+    }
+    return fresh.gamePhase == gamePhase;
+}
+
 Unmove board::makeMove(const Move& move) {
+    INSTRUMENT_COUNT(MAKE_MOVES);
     Unmove u;
 
     u.fromPiece = currentState[move.from];
@@ -41,6 +134,57 @@ Unmove board::makeMove(const Move& move) {
     u.epCapturedPiece = EMPTY;
     u.epCapturedSquare = -1;
 
+    u.prevKey = zobristKey;
+    u.prevHalfmoveClock = halfmoveClock;
+
+    // ---- Clocks and key stack ----
+    keyHistory.push_back(zobristKey);
+    bool irreversible = (u.toPiece != EMPTY || move.moved == WP || move.moved == BP);
+    halfmoveClock = irreversible ? 0 : halfmoveClock + 1;
+    if (!isWhiteTurn) fullmoveNumber++;
+
+    for (int side = 0; side < 2; ++side) {
+        u.prevMgScore[side] = mgScore[side];
+        u.prevEgScore[side] = egScore[side];
+        u.prevMaterial[side] = material[side];
+    }
+    u.prevGamePhase = gamePhase;
+
+    evalRemove(u.fromPiece, move.from);
+    evalRemove(u.toPiece, move.to);
+
+    // ---- Network accumulator: one delta per piece that moves or leaves ----
+    if (Nnue::active()) {
+        if (move.wasPromotion) {
+            Nnue::removePiece(accumulator, move.moved, move.from);
+            Nnue::addPiece(accumulator, move.promotedTo, move.to);
+        }
+        else {
+            Nnue::movePiece(accumulator, move.moved, move.from, move.to);
+        }
+        Nnue::removePiece(accumulator, u.toPiece, move.to);
+
+        if (move.wasEnPassant) {
+            if (move.moved == WP) Nnue::removePiece(accumulator, BP, move.to + 8);
+            else Nnue::removePiece(accumulator, WP, move.to - 8);
+        }
+        if (move.wasCastling) {
+            if (move.to == 62) Nnue::movePiece(accumulator, WR, 63, 61);
+            else if (move.to == 58) Nnue::movePiece(accumulator, WR, 56, 59);
+            else if (move.to == 6) Nnue::movePiece(accumulator, BR, 7, 5);
+            else if (move.to == 2) Nnue::movePiece(accumulator, BR, 0, 3);
+        }
+    }
+
+    // ---- Hash: remove old side/castle/ep, moving piece and captured piece ----
+    const Zobrist::Keys& Z = Zobrist::KEYS;
+    uint64_t key = zobristKey ^ Z.side ^ Z.castle[castleRights];
+    if (hasEnPassant) key ^= Z.enPassant[enPassantSquare];
+    key ^= Z.piece[u.fromPiece][move.from];
+    key ^= Z.piece[u.toPiece][move.to];
+    key ^= Z.castle[move.castleRights];
+    if (move.hasEnPassant) key ^= Z.enPassant[move.enPassantSquare];
+
     // ---- Promotion ----
     if (move.wasPromotion) {
         currentState[move.from] = EMPTY;
@@ -52,6 +196,12 @@ Unmove board::makeMove(const Move& move) {
 
         isWhiteTurn = !isWhiteTurn;
 
+        zobristKey = key ^ Z.piece[move.promotedTo][move.to];
+        evalAdd(move.promotedTo, move.to);
+
+#ifdef BOARD_VERIFY_EVAL
+        assert(verifyEval());
+#endif
         return u; // << FIXED
     }
 
@@ -61,35 +211,53 @@ Unmove board::makeMove(const Move& move) {
             u.epCapturedPiece = BP;
             u.epCapturedSquare = move.to + 8;
             currentState[move.to + 8] = EMPTY;
+            key ^= Z.piece[BP][move.to + 8];
+            evalRemove(BP, move.to + 8);
         }
         else {
             u.epCapturedPiece = WP;
             u.epCapturedSquare = move.to - 8;
             currentState[move.to - 8] = EMPTY;
+            key ^= Z.piece[WP][move.to - 8];
+            evalRemove(WP, move.to - 8);
         }
     }
 
     // ---- Normal piece move ----
     currentState[move.from] = EMPTY;
     currentState[move.to] = move.moved;
+    key ^= Z.piece[move.moved][move.to];
+    evalAdd(move.moved, move.to);
 
     // ---- Castling ----
     if (move.wasCastling) {
         if (move.to == 6) {
             currentState[5] = BR;
             currentState[7] = EMPTY;
+            key ^= Z.piece[BR][5] ^ Z.piece[BR][7];
+            evalRemove(BR, 7);
+            evalAdd(BR, 5);
         }
         else if (move.to == 2) {
             currentState[3] = BR;
             currentState[0] = EMPTY;
+            key ^= Z.piece[BR][3] ^ Z.piece[BR][0];
+            evalRemove(BR, 0);
+            evalAdd(BR, 3);
         }
         else if (move.to == 58) {
             currentState[59] = WR;
             currentState[56] = EMPTY;
+            key ^= Z.piece[WR][59] ^ Z.piece[WR][56];
+            evalRemove(WR, 56);
+            evalAdd(WR, 59);
         }
         else if (move.to == 62) {
             currentState[61] = WR;
             currentState[63] = EMPTY;
+            key ^= Z.piece[WR][61] ^ Z.piece[WR][63];
+            evalRemove(WR, 63);
+            evalAdd(WR, 61);
         }
     }
 
@@ -98,7 +266,11 @@ Unmove board::makeMove(const Move& move) {
     enPassantSquare = move.enPassantSquare;
     castleRights = move.castleRights;
     isWhiteTurn = !isWhiteTurn;
+    zobristKey = key;
 
+#ifdef BOARD_VERIFY_EVAL
+    assert(verifyEval());
+#endif
     return u;
 }
 
@@ -111,6 +283,46 @@ void board::unmakeMove(const Move& m, const Unmove& u) {
     castleRights = u.prevCastleRights;
     hasEnPassant = u.prevHasEnPassant;
     enPassantSquare = u.prevEnPassantSquare;
+    zobristKey = u.prevKey;
+
+    halfmoveClock = u.prevHalfmoveClock;
+    if (!u.prevTurn) fullmoveNumber--;
+    keyHistory.pop_back();
+
+    for (int side = 0; side < 2; ++side) {
+        mgScore[side] = u.prevMgScore[side];
+        egScore[side] = u.prevEgScore[side];
+        material[side] = u.prevMaterial[side];
+    }
+    gamePhase = u.prevGamePhase;
+
+    // ---- Network accumulator: the make deltas in reverse ----
+    if (Nnue::active()) {
+        if (m.wasPromotion) {
+            Nnue::removePiece(accumulator, m.promotedTo, m.to);
+            Nnue::addPiece(accumulator, m.moved, m.from);
+        }
+        else {
+            Nnue::movePiece(accumulator, m.moved, m.to, m.from);
+        }
+        Nnue::addPiece(accumulator, u.toPiece, m.to);
+        Nnue::addPiece(accumulator, u.epCapturedPiece, u.epCapturedSquare);
+
+        if (m.wasCastling) {
+            if (m.to == 62) Nnue::movePiece(accumulator, WR, 61, 63);
+            else if (m.to == 58) Nnue::movePiece(accumulator, WR, 59, 56);
+            else if (m.to == 6) Nnue::movePiece(accumulator, BR, 5, 7);
+            else if (m.to == 2) Nnue::movePiece(accumulator, BR, 3, 0);
+        }
+    }
+
+    // piece counts only change through captures and promotions
+    pieceCount[u.toPiece]++;
+    pieceCount[u.epCapturedPiece]++;
+    if (m.wasPromotion) {
+        pieceCount[m.promotedTo]--;
+        pieceCount[m.moved]++;
+    }
 
     // ---- Promotion ----
     if (m.wasPromotion) {
@@ -118,6 +330,9 @@ void board::unmakeMove(const Move& m, const Unmove& u) {
         currentState[m.from] = m.moved;
         // restore whatever was on target square
         currentState[m.to] = u.toPiece;
+#ifdef BOARD_VERIFY_EVAL
+        assert(verifyEval());
+#endif
         return; // << FIXED
     }
 
@@ -149,17 +364,80 @@ void board::unmakeMove(const Move& m, const Unmove& u) {
     if (u.epCapturedPiece != EMPTY) {
         currentState[u.epCapturedSquare] = u.epCapturedPiece;
     }
+
+#ifdef BOARD_VERIFY_EVAL
+    assert(verifyEval());
+#endif
 }
 
 
 
-void board::loadFEN(const std::string& fen) {
-    // Reset the board to the initial state
-    for (int i = 0; i < 64; i++) {
-        currentState[i] = EMPTY;
+Unmove board::makeNullMove() {
+    Unmove u;
+
+    u.fromPiece = EMPTY;
+    u.toPiece = EMPTY;
+    u.prevCastleRights = castleRights;
+    u.prevHasEnPassant = hasEnPassant;
+    u.prevEnPassantSquare = enPassantSquare;
+    u.prevTurn = isWhiteTurn;
+    u.epCapturedPiece = EMPTY;
+    u.epCapturedSquare = -1;
+    u.prevKey = zobristKey;
+    u.prevHalfmoveClock = halfmoveClock;
+
+    // a repetition can't reach across a null move, treat it as irreversible
+    keyHistory.push_back(zobristKey);
+    halfmoveClock = 0;
+
+    zobristKey ^= Zobrist::KEYS.side;
+    if (hasEnPassant) {
+        zobristKey ^= Zobrist::KEYS.enPassant[enPassantSquare];
+    }
+
+    hasEnPassant = false;
+    enPassantSquare = -1;
+    isWhiteTurn = !isWhiteTurn;
+
+    return u;
+}
+
+void board::unmakeNullMove(const Unmove& u) {
+    isWhiteTurn = u.prevTurn;
+    hasEnPassant = u.prevHasEnPassant;
+    enPassantSquare = u.prevEnPassantSquare;
+    zobristKey = u.prevKey;
+    halfmoveClock = u.prevHalfmoveClock;
+    keyHistory.pop_back();
+}
+
+bool board::isRepetition(int times) const {
+    // keyHistory[size - i] is the position i plies ago; only even i have the
+    // same side to move
+    int size = (int)keyHistory.size();
+    int limit = halfmoveClock < size ? halfmoveClock : size;
+    int found = 0;
+
+    for (int i = 4; i <= limit; i += 2) {
+        if (keyHistory[size - i] == zobristKey && ++found >= times) {
+            return true;
+        }
     }
+    return false;
+}
 
+// A FEN move counter: decimal digits only, no sign, fitting an int.
+static int parseFenCounter(const std::string& field, const char* error) {
+    if (field.empty() || field.size() > 9) throw std::invalid_argument(error);
+    int value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') throw std::invalid_argument(error);
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
 
+void board::loadFEN(const std::string& fen) {
     // FEN format parts: piecePlacement, activeColor, castleRights, enPassant, halfmoveClock, fullmoveNumber
     size_t firstSpace = fen.find(' ');
     std::string piecePlacement = fen.substr(0, firstSpace);
@@ -178,60 +456,137 @@ void board::loadFEN(const std::string& fen) {
 
     std::string fullmoveNumberstr = fen.substr(fifthSpace + 1);
 
-    // Parse piece placement
-    int index = 0;
+    // Every field is parsed into locals and checked in full before the board
+    // is touched, since the FEN may come from outside (GUI, PGN tags, the C
+    // API) and a throw must leave the previous position intact.
+
+    // Parse piece placement: 8 ranks of 8 files, a8 first, one king a side.
+    Piece placement[64];
+    int rank = 0, file = 0, whiteKings = 0, blackKings = 0;
     for (char c : piecePlacement) {
         if (c == '/') {
-            continue;  // Skip the row separator
+            if (file != 8 || rank == 7) throw std::invalid_argument("Invalid rank in FEN.");
+            ++rank;
+            file = 0;
+            continue;
         }
-        if (isdigit(c)) {
+        if (c >= '1' && c <= '8') {
             // Skip empty squares (number indicates how many)
-            index += c - '0';
-        }
-        else {
-            // Map the piece character to the corresponding piece
-            switch (c) {
-            case 'r': currentState[index] = BR; break;
-            case 'n': currentState[index] = BN; break;
-            case 'b': currentState[index] = BB; break;
-            case 'q': currentState[index] = BQ; break;
-            case 'k': currentState[index] = BK; break;
-            case 'p': currentState[index] = BP; break;
-            case 'R': currentState[index] = WR; break;
-            case 'N': currentState[index] = WN; break;
-            case 'B': currentState[index] = WB; break;
-            case 'Q': currentState[index] = WQ; break;
-            case 'K': currentState[index] = WK; break;
-            case 'P': currentState[index] = WP; break;
-            default: throw std::invalid_argument("Invalid character in FEN.");
+            for (int n = c - '0'; n > 0; --n) {
+                if (file == 8) throw std::invalid_argument("Too many files in FEN rank.");
+                placement[rank * 8 + file++] = EMPTY;
             }
-            ++index;
+            continue;
         }
+
+        Piece piece;
+        // Map the piece character to the corresponding piece
+        switch (c) {
+        case 'r': piece = BR; break;
+        case 'n': piece = BN; break;
+        case 'b': piece = BB; break;
+        case 'q': piece = BQ; break;
+        case 'k': piece = BK; ++blackKings; break;
+        case 'p': piece = BP; break;
+        case 'R': piece = WR; break;
+        case 'N': piece = WN; break;
+        case 'B': piece = WB; break;
+        case 'Q': piece = WQ; break;
+        case 'K': piece = WK; ++whiteKings; break;
+        case 'P': piece = WP; break;
+        default: throw std::invalid_argument("Invalid character in FEN.");
+        }
+        if (file == 8) throw std::invalid_argument("Too many files in FEN rank.");
+        placement[rank * 8 + file++] = piece;
     }
+    if (rank != 7 || file != 8) throw std::invalid_argument("FEN must have 8 ranks of 8 files.");
+    if (whiteKings != 1 || blackKings != 1) throw std::invalid_argument("FEN must have one king per side.");
 
     // Parse active color
-    isWhiteTurn = (activeColor == "w");
+    if (activeColor != "w" && activeColor != "b") throw std::invalid_argument("Invalid active color in FEN.");
 
     // Parse castling rights
-    castleRights = 0;  // Initialize the bitmask
-    if (castleRightsstr.find('K') != std::string::npos) castleRights |= 1;  // White kingside
-    if (castleRightsstr.find('Q') != std::string::npos) castleRights |= 2;  // White queenside
-    if (castleRightsstr.find('k') != std::string::npos) castleRights |= 4;  // Black kingside
-    if (castleRightsstr.find('q') != std::string::npos) castleRights |= 8;  // Black queenside
+    int castling = 0;  // bitmask
+    if (castleRightsstr != "-") {
+        for (char c : castleRightsstr) {
+            switch (c) {
+            case 'K': castling |= 1; break;  // White kingside
+            case 'Q': castling |= 2; break;  // White queenside
+            case 'k': castling |= 4; break;  // Black kingside
+            case 'q': castling |= 8; break;  // Black queenside
+            default: throw std::invalid_argument("Invalid castling rights in FEN.");
+            }
+        }
+    }
 
     // Parse en passant
+    int epSquare = -1;
     if (enPassant != "-") {
-        enPassantSquare = toIndex(enPassant[1] - '1', enPassant[0] - 'a');
-        hasEnPassant = true;
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h'
+            || (enPassant[1] != '3' && enPassant[1] != '6')) {
+            throw std::invalid_argument("Invalid en passant square in FEN.");
+        }
+        epSquare = toIndex('8' - enPassant[1], enPassant[0] - 'a');  // row 0 is rank 8
+    }
+
+    // Parse halfmove clock and fullmove number
+    int halfmove = parseFenCounter(halfmoveClockstr, "Invalid halfmove clock in FEN.");
+    int fullmove = parseFenCounter(fullmoveNumberstr, "Invalid fullmove number in FEN.");
+
+    // ---- Everything checked: set up the position ----
+    for (int i = 0; i < 64; i++) {
+        currentState[i] = placement[i];
+    }
+    isWhiteTurn = (activeColor == "w");
+    castleRights = castling;
+    hasEnPassant = epSquare >= 0;
+    enPassantSquare = epSquare;
+    halfmoveClock = halfmove;
+    fullmoveNumber = fullmove;
+    keyHistory.clear();
+
+    zobristKey = Zobrist::compute(*this);
+    recomputeEval();
+}
+
+std::string board::toFEN() const {
+    static const char LETTERS[] = " qrpnkbQRPNKB";     // indexed by Piece
+    std::string fen;
+
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            Piece p = currentState[toIndex(row, col)];
+            if (p == EMPTY) {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) fen += char('0' + empty);
+            empty = 0;
+            fen += LETTERS[p];
+        }
+        if (empty > 0) fen += char('0' + empty);
+        if (row < 7) fen += '/';
+    }
+
+    fen += isWhiteTurn ? " w " : " b ";
+    if (castleRights & 1) fen += 'K';
+    if (castleRights & 2) fen += 'Q';
+    if (castleRights & 4) fen += 'k';
+    if (castleRights & 8) fen += 'q';
+    if (castleRights == 0) fen += '-';
+
+    fen += ' ';
+    if (hasEnPassant) {
+        fen += char('a' + enPassantSquare % 8);
+        fen += char('8' - enPassantSquare / 8);
     }
     else {
-        hasEnPassant = false;
-        enPassantSquare = -1;
+        fen += '-';
     }
 
-    // Parse halfmove clock and fullmove number
-    halfmoveClock = std::stoi(halfmoveClockstr);
-    fullmoveNumber = std::stoi(fullmoveNumberstr);
+    fen += " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+    return fen;
 }
 
 
@@ -5,9 +5,13 @@
 #include <sstream>
 #include <stdexcept>
 #include <utility>
-#include <QDebug>
+#include <cstdint>
+#include <vector>
 
-enum Piece {
+#include "nnue.h"
+
+// One byte, so a board's squares fit in 64 bytes (see compactboard.h).
+enum Piece : uint8_t {
     EMPTY,
     BQ, BR, BP, BN, BK, BB,
     WQ, WR, WP, WN, WK, WB
@@ -26,6 +30,15 @@ struct Unmove {
     // For en-passant undo:
     Piece epCapturedPiece;
     int epCapturedSquare;    // square where it was removed
+
+    uint64_t prevKey;       // zobrist key before makeMove
+    int prevHalfmoveClock;
+
+    // incremental evaluation terms before makeMove
+    int prevMgScore[2];
+    int prevEgScore[2];
+    int prevMaterial[2];
+    int prevGamePhase;
 };
 
 
@@ -62,9 +75,18 @@ public:
     board();
     void resetBoard();
     void loadFEN(const std::string& fen);
+    std::string toFEN() const;
+    // Empties the board and puts count pieces on it, with no castling
+    // rights, no en passant and zeroed clocks. For generated positions.
+    void setPosition(const Piece* pieces, const int* squares, int count, bool whiteToMove);
     Unmove makeMove(const Move& m);
 
     void unmakeMove(const Move& m, const Unmove& u);
+
+    // Passes the turn: flips the side to move and clears en passant.
+    // Only for search (null-move pruning); never legal in a game.
+    Unmove makeNullMove();
+    void unmakeNullMove(const Unmove& u);
     inline int toIndex(int row, int col) const { return (row << 3) | col; }
     inline bool isWhitePiece(Piece p) {
         return p >= WQ && p <= WB;
@@ -73,7 +95,22 @@ public:
     inline bool isBlackPiece(Piece p) {
         return p >= BQ && p <= BB;
     }
-  
+
+    // True if the current position occurred before with the same side to
+    // move. Only keys back to the last capture or pawn move are compared.
+    bool isRepetition(int times = 1) const;
+    bool isFiftyMoveDraw() const { return halfmoveClock >= 100; }
+
+    // Recomputes the incremental evaluation terms from currentState,
+    // including the network accumulator if a network is loaded.
+    void recomputeEval();
+    // True if the incremental terms match a from-scratch recomputation.
+    // Building with BOARD_VERIFY_EVAL asserts this after every make/unmake.
+    bool verifyEval() const;
+
+private:
+    inline void evalAdd(Piece p, int sq);
+    inline void evalRemove(Piece p, int sq);
 
 public:
     Piece currentState[64];
@@ -83,6 +120,19 @@ public:
     int enPassantSquare;
     int halfmoveClock;
     int fullmoveNumber;
+
+    uint64_t zobristKey;    // kept in sync by makeMove/unmakeMove
+    std::vector<uint64_t> keyHistory;   // key before each move of the game, oldest first
+
+    // ---- Incremental evaluation terms, indexed [0] = black, [1] = white ----
+    int mgScore[2];         // material + piece-square, midgame weights
+    int egScore[2];         // material + piece-square, endgame weights
+    int material[2];        // non-king material, midgame values
+    int gamePhase;          // sum of phase weights, PHASE_MAX for the full set
+    int pieceCount[13];     // number of each Piece on the board, EMPTY entry unused
+
+    // Network first layer, only maintained while Nnue::active()
+    Nnue::Accumulator accumulator;
   
 };
 
@@ -0,0 +1,111 @@
+#include "boardwidget.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+
+static const QColor LIGHT_COLOR("#EEEED2");
+static const QColor DARK_COLOR("#769656");
+static const QColor SELECTED_COLOR(Qt::yellow);
+static const QColor MARKER_COLOR(0, 0, 0, 50);     // translucent black
+
+BoardWidget::BoardWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    static const char* PIECE_FILES[13] = {
+        nullptr,
+        "black_queen", "black_rook", "black_pawn", "black_knight", "black_king", "black_bishop",
+        "white_queen", "white_rook", "white_pawn", "white_knight", "white_king", "white_bishop"
+    };
+
+    for (int p = BQ; p <= WB; ++p) {
+        QPixmap image(QString(":/mainwindow/images/%1.png").arg(PIECE_FILES[p]));
+        pieceImages[p] = image.scaled(TILE, TILE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    for (int i = 0; i < 64; ++i) {
+        shownState[i] = EMPTY;
+    }
+
+    setFixedSize(8 * TILE, 8 * TILE);
+    setAttribute(Qt::WA_OpaquePaintEvent);  // every pixel is painted by us
+}
+
+void BoardWidget::setPosition(const Piece state[64]) {
+    QRegion dirty;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (state[sq] == shownState[sq]) continue;
+        shownState[sq] = state[sq];
+        dirty += squareRect(sq);
+    }
+    if (!dirty.isEmpty()) update(dirty);
+}
+
+void BoardWidget::setSelectedSquare(int sq) {
+    if (sq == selectedSquare) return;
+    if (selectedSquare >= 0) update(squareRect(selectedSquare));
+    selectedSquare = sq;
+    if (selectedSquare >= 0) update(squareRect(selectedSquare));
+}
+
+void BoardWidget::setTargets(const std::vector<Move>& moves) {
+    bool next[64] = {};
+    for (const Move& m : moves) {
+        next[m.to] = true;
+    }
+
+    QRegion dirty;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (next[sq] == target[sq]) continue;
+        target[sq] = next[sq];
+        dirty += squareRect(sq);
+    }
+    if (!dirty.isEmpty()) update(dirty);
+}
+
+void BoardWidget::paintEvent(QPaintEvent* event) {
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing, true);
+
+    for (int sq = 0; sq < 64; ++sq) {
+        QRect r = squareRect(sq);
+        if (!event->region().intersects(r)) continue;
+
+        // ---- Tile ----
+        bool light = ((sq / 8 + sq % 8) % 2 == 0);
+        QColor color = (sq == selectedSquare) ? SELECTED_COLOR : (light ? LIGHT_COLOR : DARK_COLOR);
+        p.fillRect(r, color);
+
+        // ---- Piece ----
+        if (shownState[sq] != EMPTY) {
+            p.drawPixmap(r.topLeft(), pieceImages[shownState[sq]]);
+        }
+
+        // ---- Move markers ----
+        if (!target[sq]) continue;
+
+        if (shownState[sq] == EMPTY) {
+            // dot on an empty target
+            p.setPen(Qt::NoPen);
+            p.setBrush(MARKER_COLOR);
+            p.drawEllipse(r.center() + QPointF(0.5, 0.5), 11, 11);
+        }
+        else {
+            // ring around a capture
+            QPen pen(MARKER_COLOR);
+            pen.setWidth(6);
+            p.setPen(pen);
+            p.setBrush(Qt::NoBrush);
+            p.drawEllipse(r.center() + QPointF(0.5, 0.5), 35, 35);
+        }
+    }
+}
+
+void BoardWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return;
+
+    int col = event->pos().x() / TILE;
+    int row = event->pos().y() / TILE;
+    if (col < 0 || col > 7 || row < 0 || row > 7) return;
+
+    emit squareClicked(row * 8 + col);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QWidget>
+#include <QPixmap>
+#include <QRegion>
+#include <vector>
+
+#include "board.h"
+
+// Chessboard drawn by a single widget: tiles, pieces, the selected square,
+// move dots and capture rings all come from one paintEvent, and clicks are
+// mapped to squares here instead of through 64 buttons.
+class BoardWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int TILE = 80;
+
+    explicit BoardWidget(QWidget* parent = nullptr);
+
+    // Repaints only the squares whose piece differs from the last call.
+    void setPosition(const Piece state[64]);
+    // -1 clears the selection.
+    void setSelectedSquare(int sq);
+    // Destination of every move is marked; pass an empty list to clear.
+    void setTargets(const std::vector<Move>& moves);
+
+signals:
+    void squareClicked(int sq);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+
+private:
+    QRect squareRect(int sq) const { return QRect((sq % 8) * TILE, (sq / 8) * TILE, TILE, TILE); }
+
+    QPixmap pieceImages[13];    // decoded once, indexed by Piece
+    Piece shownState[64];
+    int selectedSquare = -1;
+    bool target[64] = {};
+};
@@ -0,0 +1,231 @@
+#include "chesscore.h"
+#include "board.h"
+#include "movegenerator.h"
+#include "perft.h"
+#include "mlencoder.h"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+static_assert(CHESS_POLICY_SIZE == MlEncoder::POLICY_SIZE, "policy size out of sync");
+static_assert(CHESS_MASK_WORDS == MlEncoder::MASK_WORDS, "mask size out of sync");
+static_assert(CHESS_PLANE_FLOATS == MlEncoder::PLANE_FLOATS, "plane size out of sync");
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct ChessBoard {
+    board Board;
+    MoveGenerator generator;
+    std::vector<std::pair<Move, Unmove>> undoStack;
+};
+
+static uint8_t promotionCode(const Move& m) {
+    if (!m.wasPromotion) return CHESS_PROMOTE_NONE;
+    switch (m.promotedTo) {
+    case WQ: case BQ: return CHESS_PROMOTE_QUEEN;
+    case WR: case BR: return CHESS_PROMOTE_ROOK;
+    case WB: case BB: return CHESS_PROMOTE_BISHOP;
+    default: return CHESS_PROMOTE_KNIGHT;
+    }
+}
+
+static ChessMove toChessMove(const Move& m) {
+    ChessMove c;
+    c.from = (uint8_t)m.from;
+    c.to = (uint8_t)m.to;
+    c.promotion = promotionCode(m);
+    c.flags = 0;
+    if (m.captured != EMPTY || m.wasEnPassant) c.flags |= CHESS_MOVE_CAPTURE;
+    if (m.wasCastling) c.flags |= CHESS_MOVE_CASTLING;
+    if (m.wasEnPassant) c.flags |= CHESS_MOVE_EN_PASSANT;
+    if (m.wasPromotion) c.flags |= CHESS_MOVE_PROMOTION;
+    return c;
+}
+
+// loadFEN wants all six fields; tools often drop the clocks.
+static bool loadFenSafely(board& Board, const char* fen) {
+    if (!fen) return false;
+
+    std::istringstream in(fen);
+    std::string field, full;
+    int fields = 0;
+    while (in >> field) {
+        full += (fields ? " " : "") + field;
+        ++fields;
+    }
+    if (fields < 4) return false;
+    if (fields == 4) full += " 0 1";
+    else if (fields == 5) full += " 1";
+
+    try {
+        Board.loadFEN(full);
+    }
+    catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// Runs body and returns its result, or fallback if it throws (bad_alloc
+// from a move list, system_error from a thread): no C++ exception may
+// cross into the caller.
+template <class T, class Body>
+static T guarded(T fallback, Body body) {
+    try {
+        return body();
+    }
+    catch (...) {
+        return fallback;
+    }
+}
+
+extern "C" {
+
+int chess_api_version(void) {
+    return CHESSCORE_API_VERSION;
+}
+
+ChessBoard* chess_board_new(void) {
+    return guarded<ChessBoard*>(nullptr, []() {
+        ChessBoard* b = new ChessBoard();
+        b->Board.loadFEN(START_FEN);
+        return b;
+    });
+}
+
+void chess_board_free(ChessBoard* b) {
+    delete b;
+}
+
+int chess_board_set_fen(ChessBoard* b, const char* fen) {
+    if (!b) return -1;
+    return guarded(-1, [&]() {
+        b->undoStack.clear();
+
+        if (!loadFenSafely(b->Board, fen)) {
+            b->Board.loadFEN(START_FEN);
+            return -1;
+        }
+        return 0;
+    });
+}
+
+int chess_side_to_move(const ChessBoard* b) {
+    return b && b->Board.isWhiteTurn ? 1 : 0;
+}
+
+int chess_piece_at(const ChessBoard* b, int square) {
+    if (!b || square < 0 || square > 63) return CHESS_EMPTY;
+    return (int)b->Board.currentState[square];
+}
+
+uint64_t chess_board_key(const ChessBoard* b) {
+    return b ? b->Board.zobristKey : 0;
+}
+
+int chess_in_check(ChessBoard* b) {
+    if (!b) return 0;
+    bool white = b->Board.isWhiteTurn;
+    int king = b->generator.findKing(b->Board, white);
+    return king >= 0 && b->generator.isSquareAttacked(b->Board, king, !white) ? 1 : 0;
+}
+
+int chess_generate_legal(ChessBoard* b, ChessMove* out, int capacity) {
+    if (!b) return -1;
+    return guarded(-1, [&]() {
+        std::vector<Move> moves = b->generator.generateLegalMoves(b->Board);
+        int n = (int)moves.size();
+        for (int i = 0; i < n && i < capacity && out; ++i) {
+            out[i] = toChessMove(moves[i]);
+        }
+        return n;
+    });
+}
+
+int chess_make_move(ChessBoard* b, ChessMove move) {
+    if (!b) return -1;
+    return guarded(-1, [&]() {
+        for (const Move& m : b->generator.generateLegalMoves(b->Board)) {
+            if (m.from != move.from || m.to != move.to || promotionCode(m) != move.promotion) continue;
+            // room first, so a failed allocation leaves the board as it was
+            b->undoStack.reserve(b->undoStack.size() + 1);
+            Unmove u = b->Board.makeMove(m);
+            b->undoStack.emplace_back(m, u);
+            return 0;
+        }
+        return -1;
+    });
+}
+
+int chess_unmake_move(ChessBoard* b) {
+    if (!b || b->undoStack.empty()) return -1;
+
+    b->Board.unmakeMove(b->undoStack.back().first, b->undoStack.back().second);
+    b->undoStack.pop_back();
+    return 0;
+}
+
+uint64_t chess_perft(ChessBoard* b, int depth) {
+    if (!b) return 0;
+    return guarded<uint64_t>(0, [&]() { return (uint64_t)perft(b->generator, b->Board, depth); });
+}
+
+int chess_perft_batch(const char* const* fens, size_t count, int depth, uint64_t* out) {
+    if (!fens || !out) return 0;
+
+    board Board;
+    MoveGenerator generator;
+    int parsed = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        // a FEN whose perft runs out of memory counts as failed too
+        bool ok = guarded(false, [&]() {
+            if (!loadFenSafely(Board, fens[i])) return false;
+            out[i] = (uint64_t)perft(generator, Board, depth);
+            return true;
+        });
+        if (ok) ++parsed;
+        else out[i] = UINT64_MAX;
+    }
+    return parsed;
+}
+
+int chess_policy_index(ChessMove move) {
+    if (move.from > 63 || move.to > 63) return -1;
+
+    Move m(move.from, move.to, EMPTY, EMPTY, 0);
+    if (move.promotion != CHESS_PROMOTE_NONE) {
+        // only pawns promote; the rank they start from gives the colour
+        int row = move.from / 8;
+        if (row != 1 && row != 6) return -1;
+        bool white = (row == 1);
+        static const Piece PROMOTED[2][5] = {
+            { EMPTY, BQ, BR, BB, BN },
+            { EMPTY, WQ, WR, WB, WN }
+        };
+        if (move.promotion > CHESS_PROMOTE_KNIGHT) return -1;
+        m.moved = white ? WP : BP;
+        m.wasPromotion = true;
+        m.promotedTo = PROMOTED[white][move.promotion];
+    }
+    return MlEncoder::policyIndex(m);
+}
+
+int chess_encode_batch(ChessBoard* const* boards, size_t count,
+    uint64_t* masks, float* planes, int threads)
+{
+    if (!boards && count) return -1;
+    return guarded(-1, [&]() {
+        std::vector<board*> raw(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!boards[i]) return -1;
+            raw[i] = &boards[i]->Board;
+        }
+
+        MlEncoder::encodeBatch(raw.data(), count, masks, planes, threads);
+        return 0;
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,127 @@
+#ifndef CHESSCORE_H
+#define CHESSCORE_H
+
+/*
+ * C interface to the chess core (board, move generator, perft) for programs
+ * that link the core without Qt, e.g. through Python ctypes or Rust FFI.
+ *
+ * Squares are numbered 0 = a8 ... 7 = h8, 56 = a1 ... 63 = h1.
+ * Functions returning int use 0 for success and a negative value on error.
+ * No function throws or keeps a pointer passed to it after returning.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(CHESSCORE_SHARED)
+#  ifdef CHESSCORE_BUILD
+#    define CHESSCORE_API __declspec(dllexport)
+#  else
+#    define CHESSCORE_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__) && defined(CHESSCORE_SHARED)
+#  define CHESSCORE_API __attribute__((visibility("default")))
+#else
+#  define CHESSCORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHESSCORE_API_VERSION 1
+
+/* ---- Moves ---- */
+
+enum {
+    CHESS_PROMOTE_NONE = 0,
+    CHESS_PROMOTE_QUEEN = 1,
+    CHESS_PROMOTE_ROOK = 2,
+    CHESS_PROMOTE_BISHOP = 3,
+    CHESS_PROMOTE_KNIGHT = 4
+};
+
+enum {
+    CHESS_MOVE_CAPTURE = 1,
+    CHESS_MOVE_CASTLING = 2,
+    CHESS_MOVE_EN_PASSANT = 4,
+    CHESS_MOVE_PROMOTION = 8
+};
+
+/* Four bytes, layout fixed for the lifetime of API version 1. */
+typedef struct ChessMove {
+    uint8_t from;
+    uint8_t to;
+    uint8_t promotion;  /* CHESS_PROMOTE_* */
+    uint8_t flags;      /* CHESS_MOVE_*, informational; ignored by chess_make_move */
+} ChessMove;
+
+/* Pieces as returned by chess_piece_at. */
+enum {
+    CHESS_EMPTY = 0,
+    CHESS_BQ, CHESS_BR, CHESS_BP, CHESS_BN, CHESS_BK, CHESS_BB,
+    CHESS_WQ, CHESS_WR, CHESS_WP, CHESS_WN, CHESS_WK, CHESS_WB
+};
+
+typedef struct ChessBoard ChessBoard;
+
+CHESSCORE_API int chess_api_version(void);
+
+/* ---- Boards ---- */
+
+/* New board in the start position. NULL if out of memory. */
+CHESSCORE_API ChessBoard* chess_board_new(void);
+CHESSCORE_API void chess_board_free(ChessBoard* b);
+
+/* Loads a FEN; the two clock fields may be left out. Clears the undo stack.
+ * On error the board is back in the start position and -1 is returned. */
+CHESSCORE_API int chess_board_set_fen(ChessBoard* b, const char* fen);
+
+CHESSCORE_API int chess_side_to_move(const ChessBoard* b);    /* 1 = white, 0 = black */
+CHESSCORE_API int chess_piece_at(const ChessBoard* b, int square);
+CHESSCORE_API uint64_t chess_board_key(const ChessBoard* b);  /* Zobrist key */
+CHESSCORE_API int chess_in_check(ChessBoard* b);
+
+/* ---- Move generation ---- */
+
+/* Writes up to capacity legal moves to out and returns how many legal moves
+ * the position has. A return value above capacity means out was too small. */
+CHESSCORE_API int chess_generate_legal(ChessBoard* b, ChessMove* out, int capacity);
+
+/* Plays move if it is legal (from, to and promotion must match). -1 if not. */
+CHESSCORE_API int chess_make_move(ChessBoard* b, ChessMove move);
+/* Takes back the last chess_make_move. -1 if there is none. */
+CHESSCORE_API int chess_unmake_move(ChessBoard* b);
+
+/* ---- Perft ---- */
+
+CHESSCORE_API uint64_t chess_perft(ChessBoard* b, int depth);
+
+/* Batch form: perft of count FENs to the same depth, one result per FEN in
+ * out. A FEN that fails to parse gets UINT64_MAX. Returns the number of FENs
+ * that parsed. */
+CHESSCORE_API int chess_perft_batch(const char* const* fens, size_t count, int depth, uint64_t* out);
+
+/* ---- Training data ---- */
+
+/* Policy index space and input planes are described in mlencoder.h. */
+#define CHESS_POLICY_SIZE 4240
+#define CHESS_MASK_WORDS 67         /* uint64_t words of one legal-move mask */
+#define CHESS_PLANE_FLOATS 1152     /* 18 planes of 64 floats */
+
+/* Policy index of a move, whichever side makes it. -1 if not a pawn move
+ * when a promotion is given. */
+CHESSCORE_API int chess_policy_index(ChessMove move);
+
+/* Writes the legal-move mask of boards[i] to masks + i * CHESS_MASK_WORDS and
+ * its input planes to planes + i * CHESS_PLANE_FLOATS; either may be NULL.
+ * Runs on up to threads threads, 0 = all cores. Boards are left unchanged
+ * but must not be used by the caller during the call. */
+CHESSCORE_API int chess_encode_batch(ChessBoard* const* boards, size_t count,
+    uint64_t* masks, float* planes, int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHESSCORE_H */
@@ -0,0 +1,113 @@
+#include "compactboard.h"
+#include "evaluation.h"
+#include "psqt.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <cstring>
+
+CompactBoard::CompactBoard(const board& Board) {
+    std::memcpy(currentState, Board.currentState, sizeof(currentState));
+    zobristKey = Board.zobristKey;
+    mgScore = (int16_t)(Board.mgScore[1] - Board.mgScore[0]);
+    egScore = (int16_t)(Board.egScore[1] - Board.egScore[0]);
+    gamePhase = (uint8_t)Board.gamePhase;
+    castleRights = (uint8_t)Board.castleRights;
+    enPassantSquare = (int8_t)Board.enPassantSquare;
+    hasEnPassant = Board.hasEnPassant;
+    isWhiteTurn = Board.isWhiteTurn;
+    halfmoveClock = (uint8_t)std::min(Board.halfmoveClock, 255);
+    fullmoveNumber = (uint16_t)Board.fullmoveNumber;
+}
+
+void CompactBoard::expand(board& Board) const {
+    std::memcpy(Board.currentState, currentState, sizeof(currentState));
+    Board.isWhiteTurn = isWhiteTurn;
+    Board.castleRights = castleRights;
+    Board.hasEnPassant = hasEnPassant;
+    Board.enPassantSquare = enPassantSquare;
+    Board.halfmoveClock = halfmoveClock;
+    Board.fullmoveNumber = fullmoveNumber;
+    Board.keyHistory.clear();
+    Board.zobristKey = zobristKey;
+    Board.recomputeEval();
+}
+
+// ---- Copy-make ----
+
+CompactBoard CompactBoard::play(const Move& move) const {
+    const Zobrist::Keys& Z = Zobrist::KEYS;
+    CompactBoard next = *this;
+
+    Piece moved = currentState[move.from];
+    Piece captured = currentState[move.to];
+    Piece placed = move.wasPromotion ? move.promotedTo : moved;
+
+    bool irreversible = captured != EMPTY || moved == WP || moved == BP;
+    next.halfmoveClock = irreversible ? 0 : (uint8_t)std::min(halfmoveClock + 1, 255);
+    if (!isWhiteTurn) next.fullmoveNumber++;
+
+    // white pieces add to the scores, black ones subtract
+    int mg = mgScore, eg = egScore, phase = gamePhase;
+    auto remove = [&](Piece p, int sq) {
+        int sign = p >= WQ ? 1 : -1;
+        mg -= sign * PSQT.mg[p][sq];
+        eg -= sign * PSQT.eg[p][sq];
+        phase -= PSQT.phase[p];
+    };
+    auto add = [&](Piece p, int sq) {
+        int sign = p >= WQ ? 1 : -1;
+        mg += sign * PSQT.mg[p][sq];
+        eg += sign * PSQT.eg[p][sq];
+        phase += PSQT.phase[p];
+    };
+
+    uint64_t key = zobristKey ^ Z.side ^ Z.castle[castleRights] ^ Z.castle[move.castleRights];
+    if (hasEnPassant) key ^= Z.enPassant[enPassantSquare];
+    if (move.hasEnPassant) key ^= Z.enPassant[move.enPassantSquare];
+
+    key ^= Z.piece[moved][move.from] ^ Z.piece[captured][move.to] ^ Z.piece[placed][move.to];
+    remove(moved, move.from);
+    if (captured != EMPTY) remove(captured, move.to);
+    add(placed, move.to);
+    next.currentState[move.from] = EMPTY;
+    next.currentState[move.to] = placed;
+
+    if (move.wasEnPassant) {
+        int sq = moved == WP ? move.to + 8 : move.to - 8;
+        Piece pawn = moved == WP ? BP : WP;
+        next.currentState[sq] = EMPTY;
+        key ^= Z.piece[pawn][sq];
+        remove(pawn, sq);
+    }
+
+    if (move.wasCastling) {
+        int rookFrom, rookTo;
+        if (move.to == 6) { rookFrom = 7; rookTo = 5; }
+        else if (move.to == 2) { rookFrom = 0; rookTo = 3; }
+        else if (move.to == 62) { rookFrom = 63; rookTo = 61; }
+        else { rookFrom = 56; rookTo = 59; }
+        Piece rook = currentState[rookFrom];
+        next.currentState[rookFrom] = EMPTY;
+        next.currentState[rookTo] = rook;
+        key ^= Z.piece[rook][rookFrom] ^ Z.piece[rook][rookTo];
+        remove(rook, rookFrom);
+        add(rook, rookTo);
+    }
+
+    next.zobristKey = key;
+    next.mgScore = (int16_t)mg;
+    next.egScore = (int16_t)eg;
+    next.gamePhase = (uint8_t)phase;
+    next.castleRights = (uint8_t)move.castleRights;
+    next.hasEnPassant = move.hasEnPassant;
+    next.enPassantSquare = (int8_t)move.enPassantSquare;
+    next.isWhiteTurn = !isWhiteTurn;
+    return next;
+}
+
+int CompactBoard::evaluate() const {
+    int phase = gamePhase < PHASE_MAX ? gamePhase : PHASE_MAX;
+    int score = (mgScore * phase + egScore * (PHASE_MAX - phase)) / PHASE_MAX;
+    return isWhiteTurn ? score : -score;
+}
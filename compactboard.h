@@ -0,0 +1,46 @@
+#ifndef COMPACTBOARD_H
+#define COMPACTBOARD_H
+
+#include <cstdint>
+
+#include "board.h"
+
+// A position in 88 bytes, for copy-make: play() returns the position after
+// a move and leaves this one as it was, so there is no Unmove and nothing to
+// undo, and a position can be handed to another thread by value.
+//
+// Holds what MoveGenerator reads (under the same member names as board),
+// the Zobrist key and the tapered material + piece-square terms. Not kept:
+// the key history (a caller that needs repetitions keeps its own keys), the
+// per-piece counts and the network accumulator, so evaluate() is the
+// material + piece-square score only.
+class CompactBoard
+{
+public:
+    CompactBoard() {}
+    explicit CompactBoard(const board& Board);
+
+    // Sets Board to this position, with an empty key history.
+    void expand(board& Board) const;
+
+    CompactBoard play(const Move& move) const;
+
+    // Centipawns from the side to move's point of view.
+    int evaluate() const;
+
+    Piece currentState[64];
+    uint64_t zobristKey;
+    int16_t mgScore;            // white minus black, midgame weights
+    int16_t egScore;            // white minus black, endgame weights
+    uint8_t gamePhase;
+    uint8_t castleRights;
+    int8_t enPassantSquare;
+    bool hasEnPassant;
+    bool isWhiteTurn;
+    uint8_t halfmoveClock;      // saturates at 255
+    uint16_t fullmoveNumber;
+};
+
+static_assert(sizeof(CompactBoard) <= 96, "CompactBoard should stay within a cache line and a half");
+
+#endif // COMPACTBOARD_H
@@ -0,0 +1,93 @@
+// Headless training-data tool (no Qt).
+//
+//   dataset ingest <pgn> <out> [--binary] [--threads n]
+//   dataset dedup <out> <in> [<in>...] [--memory mb] [--threads n]
+//
+// ingest replays every game of a PGN archive and writes one line per
+// position ("<fen>;<uci move>;<result>;<ply>"), or with --binary one
+// Pgn::PositionRecord per position. dedup reads binary record files and
+// writes each distinct position once, spilling to sorted runs beside <out>
+// when the hash set outgrows --memory (default 1024 MB).
+
+#include "pgn.h"
+#include "dedup.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void usage() {
+    printf("usage: dataset ingest <pgn> <out> [--binary] [--threads n]\n");
+    printf("       dataset dedup <out> <in> [<in>...] [--memory mb] [--threads n]\n");
+}
+
+static int cmdIngest(int argc, char* argv[]) {
+    if (argc < 4) {
+        usage();
+        return 1;
+    }
+
+    Pgn::IngestOptions options;
+    for (int i = 4; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--binary") == 0) options.binary = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) options.threads = std::atoi(argv[++i]);
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    Pgn::IngestStats stats;
+    std::string error;
+    if (!Pgn::ingest(argv[2], argv[3], options, stats, error)) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+
+    double seconds = stats.seconds > 0.0 ? stats.seconds : 1e-9;
+    printf("games %lld (%lld skipped), positions %lld\n", stats.games, stats.skipped, stats.positions);
+    printf("%.3f s: %.0f games/s, %.1f MB/s\n", stats.seconds,
+        stats.games / seconds, stats.bytes / seconds / (1024.0 * 1024.0));
+    return 0;
+}
+
+static int cmdDedup(int argc, char* argv[]) {
+    if (argc < 4) {
+        usage();
+        return 1;
+    }
+
+    Dedup::Options options;
+    std::vector<std::string> inputs;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--memory") == 0 && i + 1 < argc) options.memoryMB = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) options.threads = std::atoi(argv[++i]);
+        else if (argv[i][0] != '-') inputs.push_back(argv[i]);
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    Dedup::Stats stats;
+    std::string error;
+    if (!Dedup::deduplicate(inputs, argv[2], options, stats, error)) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+
+    double seconds = stats.seconds > 0.0 ? stats.seconds : 1e-9;
+    printf("positions %lld, unique %lld, key collisions %lld, runs %d\n",
+        stats.input, stats.unique, stats.collisions, stats.runs);
+    printf("%.3f s: %.2f M positions/s\n", stats.seconds, stats.input / seconds / 1e6);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "ingest") == 0) return cmdIngest(argc, argv);
+    if (argc >= 2 && std::strcmp(argv[1], "dedup") == 0) return cmdDedup(argc, argv);
+    usage();
+    return 1;
+}
@@ -0,0 +1,298 @@
+#include "dedup.h"
+#include "pgn.h"
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <thread>
+
+namespace Dedup {
+
+using Pgn::PositionRecord;
+
+// ---- Hash set ----
+
+// Open addressing with linear probing. A thread claims an empty slot by
+// swapping its key in, then publishes the record through ready; a thread
+// probing the same key waits for ready before it compares positions.
+class PositionSet
+{
+public:
+    explicit PositionSet(size_t megabytes) {
+        // the slot array and the index built to sort it
+        size_t slots = megabytes * 1024 * 1024 / (sizeof(Slot) + sizeof(size_t));
+        capacity = 1024;
+        while (capacity * 2 <= slots) capacity *= 2;
+        table.reset(new Slot[capacity]);
+        clear();
+    }
+
+    // Room left before the set is too full to probe quickly.
+    size_t room() const {
+        size_t limit = capacity / 4 * 3;
+        size_t used = usedCount.load(std::memory_order_relaxed);
+        return used < limit ? limit - used : 0;
+    }
+    size_t size() const { return usedCount.load(std::memory_order_relaxed); }
+
+    // False if the position was already in the set.
+    bool insert(uint64_t key, const PositionRecord& record, long long& collisions) {
+        key = key ? key : 1;     // 0 marks an empty slot
+        for (size_t i = key & (capacity - 1); ; i = (i + 1) & (capacity - 1)) {
+            Slot& s = table[i];
+            uint64_t current = s.key.load(std::memory_order_acquire);
+            if (current == 0) {
+                if (s.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    s.record = record;
+                    s.ready.store(1, std::memory_order_release);
+                    usedCount.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                // current now holds the key that won the slot
+            }
+            if (current == key) {
+                while (!s.ready.load(std::memory_order_acquire)) std::this_thread::yield();
+                if (Pgn::samePosition(s.record, record)) return false;
+                ++collisions;
+            }
+        }
+    }
+
+    // Slot indices of every entry, in key then position order.
+    void sorted(std::vector<size_t>& order) const {
+        order.clear();
+        order.reserve(size());
+        for (size_t i = 0; i < capacity; ++i) {
+            if (table[i].key.load(std::memory_order_relaxed)) order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return less(key(a), record(a), key(b), record(b));
+        });
+    }
+
+    uint64_t key(size_t i) const { return table[i].key.load(std::memory_order_relaxed); }
+    const PositionRecord& record(size_t i) const { return table[i].record; }
+
+    void clear() {
+        for (size_t i = 0; i < capacity; ++i) {
+            table[i].key.store(0, std::memory_order_relaxed);
+            table[i].ready.store(0, std::memory_order_relaxed);
+        }
+        usedCount.store(0, std::memory_order_relaxed);
+    }
+
+    static bool less(uint64_t keyA, const PositionRecord& a, uint64_t keyB, const PositionRecord& b) {
+        if (keyA != keyB) return keyA < keyB;
+        int c = std::memcmp(a.pieces, b.pieces, sizeof(a.pieces));
+        if (c != 0) return c < 0;
+        if (a.flags != b.flags) return a.flags < b.flags;
+        return a.enPassantSquare < b.enPassantSquare;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key;
+        std::atomic<uint32_t> ready;
+        PositionRecord record;
+    };
+
+    std::unique_ptr<Slot[]> table;
+    size_t capacity = 0;
+    std::atomic<size_t> usedCount{ 0 };
+};
+
+// ---- Runs ----
+
+// A run is a file of (key, record) pairs in PositionSet::less order.
+static const size_t IO_BUFFER = 1 << 20;
+
+static bool writeEntry(FILE* f, uint64_t key, const PositionRecord& record) {
+    return fwrite(&key, sizeof(key), 1, f) == 1 && fwrite(&record, sizeof(record), 1, f) == 1;
+}
+
+static bool writeRun(const PositionSet& set, std::vector<size_t>& order, const std::string& path) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    std::vector<char> buffer(IO_BUFFER);
+    setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+
+    set.sorted(order);
+    bool ok = true;
+    for (size_t i : order) {
+        ok = ok && writeEntry(f, set.key(i), set.record(i));
+    }
+    return fclose(f) == 0 && ok;
+}
+
+struct RunReader {
+    FILE* file = nullptr;
+    std::vector<char> buffer;
+    uint64_t key = 0;
+    PositionRecord record;
+
+    bool open(const std::string& path) {
+        file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        buffer.resize(IO_BUFFER);
+        setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+        return true;
+    }
+    bool next() {
+        return fread(&key, sizeof(key), 1, file) == 1 && fread(&record, sizeof(record), 1, file) == 1;
+    }
+    ~RunReader() {
+        if (file) fclose(file);
+    }
+};
+
+// Merges the runs into out, keeping the first of each group of equal
+// positions.
+static bool mergeRuns(const std::vector<std::string>& runs, FILE* out, Stats& stats) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const std::string& path : runs) {
+        readers.emplace_back(new RunReader());
+        if (!readers.back()->open(path)) return false;
+    }
+
+    // earlier runs win ties, so the record kept is the earliest one read
+    auto later = [&](size_t a, size_t b) {
+        const RunReader& ra = *readers[a];
+        const RunReader& rb = *readers[b];
+        if (PositionSet::less(rb.key, rb.record, ra.key, ra.record)) return true;
+        if (PositionSet::less(ra.key, ra.record, rb.key, rb.record)) return false;
+        return a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i]->next()) heap.push(i);
+    }
+
+    bool first = true;
+    uint64_t lastKey = 0;
+    PositionRecord last;
+    while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        RunReader& r = *readers[i];
+
+        if (first || r.key != lastKey || !Pgn::samePosition(r.record, last)) {
+            if (fwrite(&r.record, sizeof(r.record), 1, out) != 1) return false;
+            ++stats.unique;
+            first = false;
+            lastKey = r.key;
+            last = r.record;
+        }
+        if (r.next()) heap.push(i);
+    }
+    return true;
+}
+
+// ---- Deduplication ----
+
+bool deduplicate(const std::vector<std::string>& inputs, const std::string& outPath, const Options& options,
+    Stats& stats, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    stats = Stats();
+
+    int threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+
+    PositionSet set(std::max<size_t>(1, options.memoryMB));
+    std::vector<size_t> order;
+    std::vector<std::string> runs;
+    std::vector<long long> collisions(threads, 0);
+
+    auto removeRuns = [&]() {
+        for (const std::string& path : runs) std::remove(path.c_str());
+    };
+    auto spill = [&]() {
+        std::string path = outPath + ".run" + std::to_string(runs.size());
+        runs.push_back(path);
+        if (!writeRun(set, order, path)) {
+            error = "can't write " + path;
+            return false;
+        }
+        set.clear();
+        return true;
+    };
+
+    for (const std::string& input : inputs) {
+        MappedFile file;
+        if (!file.open(input) || file.size() % sizeof(PositionRecord) != 0) {
+            error = input + " isn't a position record file";
+            removeRuns();
+            return false;
+        }
+        const uint8_t* data = file.data();
+        size_t count = file.size() / sizeof(PositionRecord);
+        stats.input += count;
+
+        // batches no larger than the room left, so the set never overfills
+        // while the threads are inserting
+        for (size_t done = 0; done < count; ) {
+            if (set.room() < std::min<size_t>(count - done, 4096) && !spill()) {
+                removeRuns();
+                return false;
+            }
+            size_t batch = std::min(count - done, set.room());
+
+            auto worker = [&](int index) {
+                size_t begin = done + batch * index / threads;
+                size_t end = done + batch * (index + 1) / threads;
+                for (size_t i = begin; i < end; ++i) {
+                    PositionRecord r;
+                    std::memcpy(&r, data + i * sizeof(PositionRecord), sizeof(r));
+                    set.insert(Pgn::recordKey(r), r, collisions[index]);
+                }
+            };
+            std::vector<std::thread> pool;
+            for (int i = 1; i < threads; ++i) pool.emplace_back(worker, i);
+            worker(0);
+            for (auto& t : pool) t.join();
+
+            done += batch;
+        }
+    }
+
+    FILE* out = fopen(outPath.c_str(), "wb");
+    if (!out) {
+        error = "can't write " + outPath;
+        removeRuns();
+        return false;
+    }
+    std::vector<char> buffer(IO_BUFFER);
+    setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+
+    bool ok;
+    if (runs.empty()) {
+        // everything fit in memory
+        set.sorted(order);
+        ok = true;
+        for (size_t i : order) {
+            ok = ok && fwrite(&set.record(i), sizeof(PositionRecord), 1, out) == 1;
+        }
+        stats.unique = (long long)order.size();
+    }
+    else {
+        ok = spill() && mergeRuns(runs, out, stats);
+    }
+    if (fclose(out) != 0) ok = false;
+    removeRuns();
+
+    for (long long c : collisions) stats.collisions += c;
+    stats.runs = (int)runs.size();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!ok) {
+        if (error.empty()) error = "can't write " + outPath;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Dedup
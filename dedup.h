@@ -0,0 +1,42 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Removes repeated positions from Pgn::PositionRecord files.
+//
+// Records go into an in-memory open-addressing hash set keyed on the
+// position's Zobrist key (Pgn::recordKey), filled by several threads at once
+// with compare-and-swap on the key slots. Full positions are only compared
+// when two keys are equal, so a key collision keeps both positions. When the
+// set reaches its memory budget it is sorted by key and written out as a run
+// file next to the output, and emptied; at the end the runs are merged, and
+// records equal to the one before them are dropped. Memory use is bounded by
+// the budget whatever the input size, and disk use by the unique positions.
+namespace Dedup {
+
+struct Options {
+    size_t memoryMB = 1024;     // hash set size
+    int threads = 0;            // 0 = one per hardware thread
+};
+
+struct Stats {
+    long long input = 0;        // records read
+    long long unique = 0;       // records written
+    long long collisions = 0;   // equal keys, different positions
+    int runs = 0;               // sorted runs spilled to disk
+    double seconds = 0.0;
+};
+
+// Writes one record of every distinct position in inputs to outPath, in
+// key order. Which record of a repeated position is kept (and so its move,
+// ply and result) is unspecified. False with a message in error if a file
+// can't be read or written.
+bool deduplicate(const std::vector<std::string>& inputs, const std::string& outPath, const Options& options,
+    Stats& stats, std::string& error);
+
+} // namespace Dedup
+
+#endif // DEDUP_H
@@ -0,0 +1,554 @@
+#include "engine.h"
+#include "evaluation.h"
+#include "tablebase.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// Lazy SMP depth staggering: helper i skips some iterations so that the
+// threads spread over neighbouring depths instead of all searching the same
+// tree in lock step. Indexed by (helper id - 1) % 20.
+static constexpr int SKIP_SIZE[20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static constexpr int SKIP_PHASE[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// Mate scores are stored relative to the node, not the root.
+static inline int scoreToTT(int score, int ply) {
+    if (score > Engine::MATE_BOUND) return score + ply;
+    if (score < -Engine::MATE_BOUND) return score - ply;
+    return score;
+}
+
+static inline int scoreFromTT(int score, int ply) {
+    if (score > Engine::MATE_BOUND) return score - ply;
+    if (score < -Engine::MATE_BOUND) return score + ply;
+    return score;
+}
+
+// Late move reduction in plies for a quiet move, by depth and move number.
+static int lmrReduction(int depth, int moveNumber) {
+    static const auto table = []() {
+        std::vector<std::vector<int>> t(Engine::MAX_PLY, std::vector<int>(64, 0));
+        for (int d = 1; d < Engine::MAX_PLY; ++d) {
+            for (int m = 1; m < 64; ++m) {
+                t[d][m] = (int)(0.75 + std::log((double)d) * std::log((double)m) / 2.25);
+            }
+        }
+        return t;
+    }();
+
+    if (depth >= Engine::MAX_PLY) depth = Engine::MAX_PLY - 1;
+    if (moveNumber > 63) moveNumber = 63;
+    return table[depth][moveNumber];
+}
+
+static bool hasNonPawnMaterial(const board& Board, bool white) {
+    if (white) {
+        return Board.pieceCount[WQ] + Board.pieceCount[WR] + Board.pieceCount[WB] + Board.pieceCount[WN] > 0;
+    }
+    return Board.pieceCount[BQ] + Board.pieceCount[BR] + Board.pieceCount[BB] + Board.pieceCount[BN] > 0;
+}
+
+Engine::Engine()
+    : tt(16), stopFlag(false) {
+}
+
+Engine::~Engine() {
+}
+
+void Engine::setOptions(const EngineOptions& newOptions) {
+    options = newOptions;
+    setThreads(newOptions.threads);
+    setHashSize(newOptions.hashMB);
+}
+
+void Engine::setThreads(int n) {
+    if (n < 1) n = 1;
+    if (n > MAX_THREADS) n = MAX_THREADS;
+    options.threads = n;
+}
+
+void Engine::setHashSize(int mb) {
+    if (mb < 1) mb = 1;
+    if ((size_t)mb != tt.sizeMB()) {
+        tt.resize(mb);
+    }
+    options.hashMB = mb;
+}
+
+void Engine::clearHash() {
+    tt.clear();
+}
+
+void Engine::stop() {
+    stopFlag.store(true, std::memory_order_relaxed);
+}
+
+void Engine::ponderhit() {
+    long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+    ponderhitTicks.store(now != 0 ? now : 1, std::memory_order_relaxed);
+}
+
+Move Engine::findBestMove(board& Board, int depth) {
+    SearchLimits depthLimit;
+    depthLimit.depth = depth < 1 ? 1 : depth;
+    return go(Board, depthLimit);
+}
+
+Move Engine::go(board& Board, const SearchLimits& searchLimits) {
+    startTime = std::chrono::steady_clock::now();
+
+    stats = SearchStats();
+    limits = searchLimits;
+    stopFlag.store(false, std::memory_order_relaxed);
+    tt.newSearch();
+
+    int depth = limits.depth > 0 ? limits.depth : MAX_PLY - 1;
+    if (depth >= MAX_PLY) depth = MAX_PLY - 1;
+
+    workers.clear();
+    for (int i = 0; i < options.threads; ++i) {
+        workers.emplace_back(new Worker());
+        workers.back()->id = i;
+        workers.back()->Board = Board;
+        // the network may have been loaded after Board was set up
+        workers.back()->Board.recomputeEval();
+    }
+
+    // ---- Helpers search until the main thread is done ----
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < options.threads; ++i) {
+        Worker* w = workers[i].get();
+        helpers.emplace_back([this, w]() {
+            iterativeDeepening(*w, MAX_PLY - 1);
+        });
+    }
+
+    Worker& mainWorker = *workers[0];
+    iterativeDeepening(mainWorker, depth);
+
+    stopFlag.store(true, std::memory_order_relaxed);
+    for (auto& t : helpers) {
+        t.join();
+    }
+
+    // ---- Report ----
+    stats.nodes = totalNodes();
+    stats.bestMove = mainWorker.bestMove;
+    stats.score = mainWorker.bestScore;
+    stats.depth = mainWorker.completedDepth;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // an early ponderhit belongs to this search; a late one to nothing
+    ponderhitTicks.store(0, std::memory_order_relaxed);
+
+    return mainWorker.bestMove;
+}
+
+void Engine::iterativeDeepening(Worker& w, int maxDepth) {
+    std::vector<Move> rootMoves = w.moveGenerator.generateLegalMoves(w.Board);
+
+    w.bestMove = Move(-1, -1, EMPTY, EMPTY, w.Board.castleRights);
+    w.bestScore = 0;
+    w.completedDepth = 0;
+
+    if (rootMoves.empty()) {
+        w.bestScore = inCheck(w) ? -MATE : 0;
+        return;
+    }
+
+    if (options.moveOrdering) {
+        std::vector<int> scores;
+        w.orderer.scoreMoves(w.Board, w.moveGenerator, rootMoves, scores, 0, 0, nullptr);
+        for (size_t i = 0; i < rootMoves.size(); ++i) {
+            MoveOrderer::pickNext(rootMoves, scores, i);
+        }
+    }
+    w.bestMove = rootMoves[0];
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (w.id > 0) {
+            int idx = (w.id - 1) % 20;
+            if (((depth + SKIP_PHASE[idx]) / SKIP_SIZE[idx]) % 2 != 0) continue;
+        }
+
+        int score = searchRoot(w, rootMoves, depth);
+
+        // an interrupted iteration is discarded
+        if (stopFlag.load(std::memory_order_relaxed)) break;
+
+        w.bestMove = rootMoves[0];
+        w.bestScore = score;
+        w.completedDepth = depth;
+
+        if (w.id == 0 && onIteration) {
+            stats.bestMove = w.bestMove;
+            stats.score = w.bestScore;
+            stats.depth = depth;
+            stats.nodes = totalNodes();
+            stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            onIteration(stats);
+        }
+    }
+}
+
+int Engine::searchRoot(Worker& w, std::vector<Move>& rootMoves, int depth) {
+    int alpha = -INF;
+    int beta = INF;
+    size_t bestIndex = 0;
+
+    w.addNode();
+
+    for (size_t i = 0; i < rootMoves.size(); ++i) {
+        const Move& m = rootMoves[i];
+        w.moveStack[0] = m;
+
+        Unmove u = w.Board.makeMove(m);
+        int newDepth = depth - 1;
+        if (options.checkExtensions && inCheck(w)) newDepth++;
+
+        int score;
+        if (i == 0 || !options.pvs) {
+            score = -search(w, newDepth, -beta, -alpha, 1);
+        }
+        else {
+            score = -search(w, newDepth, -alpha - 1, -alpha, 1);
+            if (score > alpha && !stopFlag.load(std::memory_order_relaxed)) {
+                score = -search(w, newDepth, -beta, -alpha, 1);
+            }
+        }
+        w.Board.unmakeMove(m, u);
+
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score > alpha) {
+            alpha = score;
+            bestIndex = i;
+        }
+    }
+
+    // best move first so the next iteration searches it first
+    if (bestIndex != 0) {
+        Move best = rootMoves[bestIndex];
+        rootMoves.erase(rootMoves.begin() + bestIndex);
+        rootMoves.insert(rootMoves.begin(), best);
+    }
+
+    tt.store(w.Board.zobristKey, depth, scoreToTT(alpha, 0), TT_EXACT,
+        TranspositionTable::packMove(rootMoves[0]));
+
+    return alpha;
+}
+
+int Engine::search(Worker& w, int depth, int alpha, int beta, int ply) {
+    if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+    // ---- Draws ----
+    // One earlier occurrence is enough inside the tree: if repeating is
+    // best once it is best again, so the line is a draw.
+    if (options.drawDetection && (w.Board.isFiftyMoveDraw() || w.Board.isRepetition())) {
+        return DRAW;
+    }
+
+    // ---- Tablebases ----
+    // Exact inside the tree; the root still searches so that it has a move.
+    if (ply > 0 && Tablebase::maxPieces() > 0) {
+        int pieces = 0;
+        for (int p = BQ; p <= WB; ++p) pieces += w.Board.pieceCount[p];
+        Tablebase::ProbeResult tb;
+        if (pieces <= Tablebase::maxPieces() && Tablebase::probe(w.Board, tb)) {
+            w.addNode();
+            if (tb.wdl == Tablebase::DRAW) return DRAW;
+            int score = MATE - ply - tb.plies;
+            return tb.wdl == Tablebase::WIN ? score : -score;
+        }
+    }
+
+    if (depth <= 0) {
+        if (options.quiescence) {
+            return quiescence(w, alpha, beta, ply);
+        }
+        w.addNode();
+        return evaluate(w.Board);
+    }
+
+    if ((w.addNode() & 2047) == 0 && w.id == 0) {
+        checkLimits(w);
+    }
+
+    if (ply >= MAX_PLY) {
+        return evaluate(w.Board);
+    }
+
+    bool pvNode = (beta - alpha > 1);
+
+    // ---- Transposition table ----
+    uint64_t key = w.Board.zobristKey;
+    uint16_t ttMove = 0;
+    TTData tte;
+    if (tt.probe(key, tte)) {
+        ttMove = tte.move;
+        if (tte.depth >= depth) {
+            int ttScore = scoreFromTT(tte.score, ply);
+            if (tte.bound == TT_EXACT) return ttScore;
+            if (tte.bound == TT_LOWER && ttScore >= beta) return ttScore;
+            if (tte.bound == TT_UPPER && ttScore <= alpha) return ttScore;
+        }
+    }
+
+    bool checked = inCheck(w);
+
+    // ---- Null-move pruning ----
+    // Zugzwang guards: never in check, never twice in a row, and only while
+    // the side to move still has a piece other than pawns.
+    if (options.nullMove && !checked && depth >= 3
+        && w.moveStack[ply - 1].moved != EMPTY
+        && beta < MATE_BOUND
+        && hasNonPawnMaterial(w.Board, w.Board.isWhiteTurn)
+        && evaluate(w.Board) >= beta)
+    {
+        int R = depth >= 6 ? 3 : 2;
+
+        w.moveStack[ply] = Move(0, 0, EMPTY, EMPTY, w.Board.castleRights);
+        Unmove u = w.Board.makeNullMove();
+        int score = -search(w, depth - 1 - R, -beta, -beta + 1, ply + 1);
+        w.Board.unmakeNullMove(u);
+
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score >= beta) {
+            return score >= MATE_BOUND ? beta : score;
+        }
+    }
+
+    std::vector<Move> moves = w.moveGenerator.generateLegalMoves(w.Board);
+    if (moves.empty()) {
+        return checked ? -MATE + ply : 0;
+    }
+
+    // ---- Move ordering ----
+    const Move* prevMove = &w.moveStack[ply - 1];
+    std::vector<int> scores;
+    if (options.moveOrdering) {
+        w.orderer.scoreMoves(w.Board, w.moveGenerator, moves, scores, ttMove, ply, prevMove);
+    }
+    else if (ttMove) {
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (TranspositionTable::sameMove(ttMove, moves[i])) {
+                std::swap(moves[0], moves[i]);
+                break;
+            }
+        }
+    }
+
+    int alphaOrig = alpha;
+    int bestScore = -INF;
+    uint16_t bestMove = 0;
+    std::vector<Move> quietsTried;
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (options.moveOrdering) {
+            MoveOrderer::pickNext(moves, scores, i);
+        }
+        const Move& m = moves[i];
+        bool quiet = MoveOrderer::isQuiet(m);
+        w.moveStack[ply] = m;
+
+        Unmove u = w.Board.makeMove(m);
+
+        bool givesCheck = inCheck(w);
+        int newDepth = depth - 1;
+        if (options.checkExtensions && givesCheck) newDepth++;
+
+        // ---- Late move reductions: late quiet moves get a shallower look ----
+        int reduction = 0;
+        if (options.lmr && depth >= 3 && i >= 3 && quiet && !checked && !givesCheck) {
+            reduction = lmrReduction(depth, (int)i);
+            if (pvNode && reduction > 0) reduction--;
+            if (reduction > newDepth - 1) reduction = newDepth - 1;
+            if (reduction < 0) reduction = 0;
+        }
+
+        int score;
+        if (i == 0) {
+            score = -search(w, newDepth, -beta, -alpha, ply + 1);
+        }
+        else {
+            // PVS: later moves only need to prove they are not better
+            int nullAlpha = options.pvs ? -alpha - 1 : -beta;
+
+            score = -search(w, newDepth - reduction, nullAlpha, -alpha, ply + 1);
+            if (reduction > 0 && score > alpha) {
+                score = -search(w, newDepth, nullAlpha, -alpha, ply + 1);
+            }
+            if (options.pvs && score > alpha && score < beta) {
+                score = -search(w, newDepth, -beta, -alpha, ply + 1);
+            }
+        }
+
+        w.Board.unmakeMove(m, u);
+
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = TranspositionTable::packMove(m);
+
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    if (options.moveOrdering && quiet) {
+                        w.orderer.updateQuiet(m, depth, ply, prevMove, quietsTried);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (quiet) {
+            quietsTried.push_back(m);
+        }
+    }
+
+    int bound = bestScore >= beta ? TT_LOWER
+        : (bestScore > alphaOrig ? TT_EXACT : TT_UPPER);
+    tt.store(key, depth, scoreToTT(bestScore, ply), bound, bestMove);
+
+    return bestScore;
+}
+
+int Engine::quiescence(Worker& w, int alpha, int beta, int ply) {
+    // victim/attacker values for the SEE shortcut, indexed by Piece
+    static constexpr int QS_VALUE[13] = { 0, 900, 500, 100, 300, 20000, 300, 900, 500, 100, 300, 20000, 300 };
+
+    if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+    if ((w.addNode() & 2047) == 0 && w.id == 0) {
+        checkLimits(w);
+    }
+
+    if (ply >= MAX_PLY) {
+        return evaluate(w.Board);
+    }
+
+    bool checked = inCheck(w);
+    int bestScore;
+    std::vector<Move>& moves = w.qsMoves[ply];
+
+    if (checked) {
+        // no stand-pat while in check: every evasion is searched
+        w.moveGenerator.generateLegalMoves(w.Board, moves);
+        if (moves.empty()) {
+            return -MATE + ply;
+        }
+        bestScore = -INF;
+    }
+    else {
+        bestScore = evaluate(w.Board);
+        if (bestScore >= beta) return bestScore;
+        if (bestScore > alpha) alpha = bestScore;
+
+        w.moveGenerator.generateLegalCaptures(w.Board, moves);
+    }
+
+    std::vector<int>& scores = w.qsScores[ply];
+    scores.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); ++i) {
+        scores[i] = MoveOrderer::mvvLva(moves[i]) + (moves[i].wasPromotion ? 1000 : 0);
+    }
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        MoveOrderer::pickNext(moves, scores, i);
+        const Move& m = moves[i];
+
+        // losing captures are pruned before they are made; a capture of an
+        // equal or bigger piece can never lose material, so skip SEE there
+        if (!checked && options.seePruning && !m.wasPromotion
+            && QS_VALUE[m.captured] < QS_VALUE[m.moved]
+            && w.moveGenerator.staticExchange(w.Board, m) < 0) {
+            continue;
+        }
+
+        Unmove u = w.Board.makeMove(m);
+        int score = -quiescence(w, -beta, -alpha, ply + 1);
+        w.Board.unmakeMove(m, u);
+
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+bool Engine::inCheck(Worker& w) {
+    int kingSq = w.moveGenerator.findKing(w.Board, w.Board.isWhiteTurn);
+    return kingSq >= 0 && w.moveGenerator.isSquareAttacked(w.Board, kingSq, !w.Board.isWhiteTurn);
+}
+
+void Engine::checkLimits(Worker& w) {
+    if (limits.nodes > 0 && w.nodes.load(std::memory_order_relaxed) >= limits.nodes) {
+        stopFlag.store(true, std::memory_order_relaxed);
+    }
+
+    if (limits.movetimeMs > 0) {
+        auto now = std::chrono::steady_clock::now();
+        auto from = startTime;
+
+        if (limits.ponder) {
+            long long ticks = ponderhitTicks.load(std::memory_order_relaxed);
+            if (ticks == 0) return;     // still pondering: no clock yet
+            from = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - from).count();
+        if (elapsed >= limits.movetimeMs) {
+            stopFlag.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+long long Engine::totalNodes() const {
+    long long total = 0;
+    for (const auto& w : workers) {
+        total += w->nodes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::vector<Move> Engine::principalVariation(const board& Board, int maxLength) {
+    std::vector<Move> pv;
+    std::vector<uint64_t> seen;
+    board b = Board;
+    MoveGenerator generator;
+
+    while ((int)pv.size() < maxLength) {
+        TTData tte;
+        if (!tt.probe(b.zobristKey, tte) || tte.move == 0) break;
+
+        // stop at the first repeated position, the line would loop forever
+        for (uint64_t k : seen) {
+            if (k == b.zobristKey) return pv;
+        }
+        seen.push_back(b.zobristKey);
+
+        bool found = false;
+        for (const Move& m : generator.generateLegalMoves(b)) {
+            if (TranspositionTable::sameMove(tte.move, m)) {
+                pv.push_back(m);
+                b.makeMove(m);
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+    }
+
+    return pv;
+}
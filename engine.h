@@ -0,0 +1,134 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+#include "transpositiontable.h"
+#include "moveorder.h"
+#include "instrument.h"
+#include "tablebase.h"
+
+struct EngineOptions {
+    int threads = 1;    // 1 = main thread only, n > 1 adds n - 1 Lazy SMP helpers
+    int hashMB = 16;
+    bool moveOrdering = true;   // MVV-LVA, killers, history, counter-moves; off = hash move only
+    bool quiescence = true;     // capture-only search at the leaves; off = static eval
+    bool seePruning = true;     // skip captures with negative SEE in quiescence
+    bool pvs = true;            // principal variation search with zero-window re-searches
+    bool nullMove = true;       // null-move pruning
+    bool lmr = true;            // late move reductions for quiet moves
+    bool checkExtensions = true;
+    bool drawDetection = true;  // score repetitions and fifty-move positions as draws
+};
+
+struct SearchLimits {
+    int depth = 0;              // 0 = no depth limit
+    int movetimeMs = 0;         // 0 = no time limit
+    long long nodes = 0;        // 0 = no node limit, counted on the main thread
+    bool ponder = false;        // movetime only starts counting at ponderhit()
+};
+
+struct SearchStats {
+    Move bestMove;
+    int score = 0;
+    int depth = 0;          // last depth completed by the main thread
+    long long nodes = 0;    // summed over all threads
+    double seconds = 0.0;
+};
+
+class Engine
+{
+public:
+    Engine();
+    ~Engine();
+
+    // Searches Board to the given depth and returns the main thread's best
+    // move. Board is left unchanged. Returns a move with from == -1 if the
+    // side to move has no legal moves.
+    Move findBestMove(board& Board, int depth);
+
+    // Searches until one of the limits is hit or stop() is called.
+    Move go(board& Board, const SearchLimits& limits);
+
+    void setOptions(const EngineOptions& newOptions);
+    const EngineOptions& getOptions() const { return options; }
+    void setThreads(int n);
+    void setHashSize(int mb);
+    void clearHash();
+
+    // Safe to call from another thread while findBestMove is running.
+    void stop();
+    // Ends pondering: a search started with limits.ponder begins to count its
+    // movetime from now. May arrive before the search itself has started.
+    void ponderhit();
+
+    // Called on the main search thread after every completed iteration.
+    void setInfoCallback(std::function<void(const SearchStats&)> callback) { onIteration = callback; }
+
+    // Best line from Board found by walking the transposition table.
+    std::vector<Move> principalVariation(const board& Board, int maxLength = MAX_PLY);
+    int hashfull() const { return tt.hashfull(); }
+
+    const SearchStats& lastSearch() const { return stats; }
+
+    static constexpr int MAX_PLY = 64;
+    static constexpr int MAX_THREADS = 256;
+    static constexpr int INF = 32000;
+    static constexpr int MATE = 31000;
+    // |score| above this is a mate: found in the tree, or a tablebase mate
+    // of up to Tablebase::MAX_PLIES plies probed at any ply
+    static constexpr int MATE_BOUND = MATE - MAX_PLY - Tablebase::MAX_PLIES;
+    static constexpr int DRAW = 0;
+
+private:
+    // Per-thread search state. Lazy SMP threads share nothing but the
+    // transposition table; each gets its own board copy and generator.
+    struct Worker {
+        int id = 0;
+        board Board;
+        MoveGenerator moveGenerator;
+        std::atomic<long long> nodes{ 0 };     // read by the main thread for reports
+        int completedDepth = 0;
+        Move bestMove;
+        int bestScore = 0;
+        MoveOrderer orderer;
+        Move moveStack[MAX_PLY];    // move played at each ply, for counter-moves
+        std::vector<Move> qsMoves[MAX_PLY];     // quiescence move lists, kept to reuse their capacity
+        std::vector<int> qsScores[MAX_PLY];
+
+        // Only this worker writes its counter, so a plain load/store pair
+        // is enough and avoids a locked add on every node.
+        long long addNode() {
+            INSTRUMENT_COUNT(SEARCH_NODES);
+            long long n = nodes.load(std::memory_order_relaxed) + 1;
+            nodes.store(n, std::memory_order_relaxed);
+            return n;
+        }
+    };
+
+    void iterativeDeepening(Worker& w, int maxDepth);
+    int searchRoot(Worker& w, std::vector<Move>& rootMoves, int depth);
+    int search(Worker& w, int depth, int alpha, int beta, int ply);
+    int quiescence(Worker& w, int alpha, int beta, int ply);
+    bool inCheck(Worker& w);
+    void checkLimits(Worker& w);
+    long long totalNodes() const;
+
+    EngineOptions options;
+    TranspositionTable tt;
+    std::atomic<bool> stopFlag;
+    SearchStats stats;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<long long> ponderhitTicks{ 0 };    // steady_clock ticks, 0 = still pondering
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::function<void(const SearchStats&)> onIteration;
+};
+
+#endif // ENGINE_H
@@ -0,0 +1,53 @@
+#include "evaluation.h"
+#include "kpk.h"
+
+static constexpr int KNOWN_WIN = 10000;     // well clear of any material score, below mate
+
+// King and pawn against king is looked up in the bitbase: a draw scores 0,
+// a win KNOWN_WIN plus a bonus for each rank the pawn has advanced, so the
+// search still pushes it. False for any other material.
+static bool evaluateKpk(const board& Board, int& score) {
+    if (Board.gamePhase != 0 || Board.pieceCount[WP] + Board.pieceCount[BP] != 1) return false;
+
+    bool whitePawn = Board.pieceCount[WP] == 1;
+    int strongKing = -1, weakKing = -1, pawn = -1;
+    for (int sq = 0; sq < 64; ++sq) {
+        Piece p = Board.currentState[sq];
+        if (p == WK) (whitePawn ? strongKing : weakKing) = sq;
+        else if (p == BK) (whitePawn ? weakKing : strongKing) = sq;
+        else if (p == WP || p == BP) pawn = sq;
+    }
+
+    // bitbase squares have the pawn moving up the board as white
+    if (!whitePawn) {
+        strongKing ^= 56;
+        weakKing ^= 56;
+        pawn ^= 56;
+    }
+    bool strongToMove = Board.isWhiteTurn == whitePawn;
+
+    score = 0;
+    if (Kpk::probe(strongKing, weakKing, pawn, strongToMove)) {
+        score = KNOWN_WIN + 20 * (6 - pawn / 8);
+    }
+    if (!strongToMove) score = -score;
+    return true;
+}
+
+int evaluate(const board& Board) {
+    int kpkScore;
+    if (evaluateKpk(Board, kpkScore)) return kpkScore;
+
+    if (Nnue::active()) {
+        return Nnue::evaluate(Board.accumulator, Board.isWhiteTurn);
+    }
+
+    // material and piece-square totals are maintained by makeMove/unmakeMove
+    int phase = Board.gamePhase < PHASE_MAX ? Board.gamePhase : PHASE_MAX;
+
+    int mgScore = Board.mgScore[1] - Board.mgScore[0];
+    int egScore = Board.egScore[1] - Board.egScore[0];
+    int score = (mgScore * phase + egScore * (PHASE_MAX - phase)) / PHASE_MAX;
+
+    return Board.isWhiteTurn ? score : -score;
+}
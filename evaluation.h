@@ -0,0 +1,15 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "board.h"
+
+// Exact scores for king and pawn against king (see kpk.h). Otherwise the
+// network evaluation when one is loaded (see nnue.h), or tapered material +
+// piece-square evaluation.
+// Scores are in centipawns from the side to move's point of view.
+
+static constexpr int PHASE_MAX = 24;    // N/B = 1, R = 2, Q = 4 for the full starting set
+
+int evaluate(const board& Board);
+
+#endif // EVALUATION_H
@@ -0,0 +1,60 @@
+#include "gamehistory.h"
+#include "notation.h"
+
+#include <cassert>
+
+void GameHistory::push(board& Board, const Move& m, bool startsGroup) {
+    entries.resize(current);
+
+    HistoryEntry e;
+    e.move = m;
+    e.san = moveToSan(Board, generator, m);
+    e.undo = Board.makeMove(m);
+    e.key = Board.zobristKey;
+    e.startsGroup = startsGroup || current == 0;
+    entries.push_back(e);
+    ++current;
+}
+
+bool GameHistory::undo(board& Board) {
+    if (!canUndo()) return false;
+
+    do {
+        stepBack(Board);
+    } while (current > 0 && !entries[current].startsGroup);
+    return true;
+}
+
+bool GameHistory::redo(board& Board) {
+    if (!canRedo()) return false;
+
+    do {
+        stepForward(Board);
+    } while (canRedo() && !entries[current].startsGroup);
+    return true;
+}
+
+void GameHistory::goToPly(board& Board, int ply) {
+    if (ply < 0) ply = 0;
+    if (ply > (int)entries.size()) ply = (int)entries.size();
+
+    while (current > ply) stepBack(Board);
+    while (current < ply) stepForward(Board);
+}
+
+void GameHistory::clear() {
+    entries.clear();
+    current = 0;
+}
+
+void GameHistory::stepBack(board& Board) {
+    const HistoryEntry& e = entries[--current];
+    assert(Board.zobristKey == e.key);
+    Board.unmakeMove(e.move, e.undo);
+}
+
+void GameHistory::stepForward(board& Board) {
+    HistoryEntry& e = entries[current++];
+    e.undo = Board.makeMove(e.move);
+    assert(Board.zobristKey == e.key);
+}
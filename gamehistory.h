@@ -0,0 +1,53 @@
+#ifndef GAMEHISTORY_H
+#define GAMEHISTORY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+
+struct HistoryEntry {
+    Move move;
+    Unmove undo;        // returned by makeMove, restores the position before move
+    uint64_t key;       // zobrist key after move
+    bool startsGroup;   // false for an engine reply bundled with the user move before it
+    std::string san;    // move in SAN, written in the position before it
+};
+
+// Moves played in a game, with a cursor for undo/redo. Every step is one
+// makeMove or unmakeMove on the live board, so undo, redo and jumping to a
+// ply never replay the game from the start position.
+class GameHistory
+{
+public:
+    // Plays m on Board. Anything that could have been redone is dropped.
+    void push(board& Board, const Move& m, bool startsGroup = true);
+
+    // Takes back the last group (a user move and its engine reply) or
+    // replays the next one. Return false when there is nothing to do.
+    bool undo(board& Board);
+    bool redo(board& Board);
+
+    // Steps Board to the position after the first ply moves, 0 = start.
+    void goToPly(board& Board, int ply);
+
+    void clear();
+
+    int ply() const { return current; }
+    int size() const { return (int)entries.size(); }
+    bool canUndo() const { return current > 0; }
+    bool canRedo() const { return current < (int)entries.size(); }
+    const HistoryEntry& at(int i) const { return entries[i]; }
+
+private:
+    void stepBack(board& Board);
+    void stepForward(board& Board);
+
+    std::vector<HistoryEntry> entries;
+    int current = 0;    // number of entries applied to the board
+    MoveGenerator generator;    // for SAN
+};
+
+#endif // GAMEHISTORY_H
@@ -0,0 +1,146 @@
+#include "instrument.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace Instrument {
+
+static const char* COUNTER_NAMES[COUNTER_COUNT] = {
+    "legalGenerations",
+    "pseudoLegalMoves",
+    "illegalRejected",
+    "squareAttackedCalls",
+    "canCastleCalls",
+    "canCastleRejected",
+    "makeMoves",
+    "searchNodes",
+};
+
+static const char* TIMER_NAMES[TIMER_COUNT] = {
+    "generateLegalMoves",
+    "generatePseudoLegalMoves",
+    "staticExchange",
+};
+
+#ifdef MOVEGEN_INSTRUMENT
+
+// Live thread blocks and the sum of blocks whose thread has exited.
+static std::mutex registryMutex;
+static std::vector<ThreadBlock*>& liveBlocks() {
+    static std::vector<ThreadBlock*> blocks;
+    return blocks;
+}
+static Totals retired;
+
+static void addInto(Totals& sum, const Totals& t) {
+    for (int i = 0; i < COUNTER_COUNT; ++i) sum.counters[i] += t.counters[i];
+    for (int i = 0; i < TIMER_COUNT; ++i) {
+        sum.timerNs[i] += t.timerNs[i];
+        sum.timerCalls[i] += t.timerCalls[i];
+    }
+}
+
+ThreadBlock::ThreadBlock() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    liveBlocks().push_back(this);
+}
+
+ThreadBlock::~ThreadBlock() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    addInto(retired, totals);
+    auto& blocks = liveBlocks();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i] == this) {
+            blocks.erase(blocks.begin() + i);
+            break;
+        }
+    }
+}
+
+ThreadBlock& local() {
+    static thread_local ThreadBlock block;
+    return block;
+}
+
+static uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ScopedTimer::ScopedTimer(Timer t)
+    : timer(t), start(nowNs()) {
+}
+
+ScopedTimer::~ScopedTimer() {
+    Totals& totals = local().totals;
+    totals.timerNs[timer] += nowNs() - start;
+    totals.timerCalls[timer]++;
+}
+
+// Blocks of other threads are read while they may still be counting; the
+// numbers are meant to be read once the work is done.
+Totals aggregate() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Totals sum = retired;
+    for (ThreadBlock* b : liveBlocks()) {
+        addInto(sum, b->totals);
+    }
+    return sum;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    retired = Totals();
+    for (ThreadBlock* b : liveBlocks()) {
+        b->totals = Totals();
+    }
+}
+
+#else
+
+Totals aggregate() {
+    return Totals();
+}
+
+void reset() {
+}
+
+#endif
+
+std::string toJson(const Totals& totals) {
+    char buf[160];
+    std::string json = "{\"enabled\":";
+    json += enabled() ? "true" : "false";
+
+    json += ",\"counters\":{";
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":%llu", i ? "," : "", COUNTER_NAMES[i],
+            (unsigned long long)totals.counters[i]);
+        json += buf;
+    }
+
+    json += "},\"timers\":{";
+    for (int i = 0; i < TIMER_COUNT; ++i) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":{\"calls\":%llu,\"ns\":%llu}", i ? "," : "", TIMER_NAMES[i],
+            (unsigned long long)totals.timerCalls[i], (unsigned long long)totals.timerNs[i]);
+        json += buf;
+    }
+
+    // ---- Derived ratios ----
+    auto ratio = [](uint64_t a, uint64_t b) { return b ? (double)a / (double)b : 0.0; };
+    const uint64_t* c = totals.counters;
+    uint64_t nodes = c[SEARCH_NODES] ? c[SEARCH_NODES] : c[MAKE_MOVES];
+
+    snprintf(buf, sizeof(buf), "},\"ratios\":{\"illegalRate\":%.4f,\"squareAttackedPerNode\":%.3f,"
+        "\"canCastleRejectRate\":%.4f}}",
+        ratio(c[ILLEGAL_REJECTED], c[PSEUDO_LEGAL_MOVES]),
+        ratio(c[SQUARE_ATTACKED_CALLS], nodes),
+        ratio(c[CAN_CASTLE_REJECTED], c[CAN_CASTLE_CALLS]));
+    json += buf;
+
+    return json;
+}
+
+} // namespace Instrument
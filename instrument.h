@@ -0,0 +1,92 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// Hot-path counters and scoped timers. Build with MOVEGEN_INSTRUMENT defined
+// to enable them; otherwise every INSTRUMENT_* macro expands to nothing and
+// no code or data is left in the hot functions.
+//
+// Each thread counts into its own thread_local block, so counting is a plain
+// increment. aggregate() sums the blocks of live threads with those of
+// threads that have already exited.
+
+#include <cstdint>
+#include <string>
+
+namespace Instrument {
+
+enum Counter {
+    LEGAL_GENERATIONS,      // generateLegalMoves calls
+    PSEUDO_LEGAL_MOVES,     // moves produced by generatePseudoLegalMoves
+    ILLEGAL_REJECTED,       // pseudo-legal moves dropped by generateLegalMoves
+    SQUARE_ATTACKED_CALLS,
+    CAN_CASTLE_CALLS,
+    CAN_CASTLE_REJECTED,
+    MAKE_MOVES,
+    SEARCH_NODES,
+    COUNTER_COUNT
+};
+
+enum Timer {
+    TIME_LEGAL_MOVES,
+    TIME_PSEUDO_LEGAL_MOVES,
+    TIME_STATIC_EXCHANGE,
+    TIMER_COUNT
+};
+
+struct Totals {
+    uint64_t counters[COUNTER_COUNT] = {};
+    uint64_t timerNs[TIMER_COUNT] = {};
+    uint64_t timerCalls[TIMER_COUNT] = {};
+};
+
+#ifdef MOVEGEN_INSTRUMENT
+
+struct ThreadBlock {
+    Totals totals;
+    ThreadBlock();
+    ~ThreadBlock();     // folds the totals into the retired sum
+};
+
+ThreadBlock& local();
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer t);
+    ~ScopedTimer();
+private:
+    Timer timer;
+    uint64_t start;
+};
+
+#define INSTRUMENT_COUNT(c) (++Instrument::local().totals.counters[Instrument::c])
+#define INSTRUMENT_ADD(c, n) (Instrument::local().totals.counters[Instrument::c] += (n))
+#define INSTRUMENT_CONCAT2(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT2(a, b)
+#define INSTRUMENT_SCOPE(t) Instrument::ScopedTimer INSTRUMENT_CONCAT(instrumentTimer, __LINE__)(Instrument::t)
+
+#else
+
+#define INSTRUMENT_COUNT(c) ((void)0)
+#define INSTRUMENT_ADD(c, n) ((void)0)
+#define INSTRUMENT_SCOPE(t) ((void)0)
+
+#endif
+
+constexpr bool enabled() {
+#ifdef MOVEGEN_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Sum over all threads since the last reset(). All zero when disabled.
+Totals aggregate();
+void reset();
+
+// One-line JSON object with every counter and timer plus derived ratios.
+std::string toJson(const Totals& totals);
+
+} // namespace Instrument
+
+#endif // INSTRUMENT_H
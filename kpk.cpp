@@ -0,0 +1,309 @@
+#include "kpk.h"
+#include "board.h"
+#include "movegenerator.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Kpk {
+
+static uint8_t bits[POSITIONS / 8];
+static std::once_flag built;
+
+enum Result : uint8_t { UNKNOWN, INVALID, DRAW, WIN };
+
+// Successor entries are table indices, or one of these for positions that
+// leave the table: a promotion or the pawn being taken.
+static constexpr int32_t SUCC_WIN = -1;
+static constexpr int32_t SUCC_DRAW = -2;
+
+// ---- Indexing ----
+
+// pawn on rows 1..6 (ranks 7..2) and files 0..3
+static int index(int wk, int bk, int pawn, bool whiteToMove) {
+    int pawnIndex = (pawn / 8 - 1) * 4 + pawn % 8;
+    return ((pawnIndex * 64 + wk) * 64 + bk) * 2 + (whiteToMove ? 1 : 0);
+}
+
+static void decode(int idx, int& wk, int& bk, int& pawn, bool& whiteToMove) {
+    whiteToMove = idx & 1;
+    idx >>= 1;
+    bk = idx & 63;
+    idx >>= 6;
+    wk = idx & 63;
+    idx >>= 6;
+    pawn = (idx / 4 + 1) * 8 + idx % 4;
+}
+
+static bool adjacent(int a, int b) {
+    int dr = a / 8 - b / 8, df = a % 8 - b % 8;
+    return dr >= -1 && dr <= 1 && df >= -1 && df <= 1;
+}
+
+// white pawns capture towards row 0
+static bool pawnAttacks(int pawn, int sq) {
+    int df = sq % 8 - pawn % 8;
+    return sq / 8 == pawn / 8 - 1 && (df == 1 || df == -1);
+}
+
+static bool isValid(int wk, int bk, int pawn, bool whiteToMove) {
+    if (wk == bk || wk == pawn || bk == pawn) return false;
+    if (adjacent(wk, bk)) return false;
+    // the side not to move can't be in check
+    if (whiteToMove && pawnAttacks(pawn, bk)) return false;
+    return true;
+}
+
+// ---- Retrograde analysis over MoveGenerator ----
+
+// Position after m has been made on b, which was (wk, bk, pawn).
+static int32_t successor(board& b, MoveGenerator& generator, const Move& m,
+    int wk, int bk, int pawn, std::vector<Move>& replies) {
+    if (m.captured == WP) return SUCC_DRAW;     // bare kings
+
+    if (m.wasPromotion) {
+        // a queen or rook wins unless it is taken at once or black is
+        // stalemated; a minor piece only wins by mating on the spot
+        generator.generateLegalMoves(b, replies);
+        if (replies.empty()) {
+            return generator.isSquareAttacked(b, bk, true) ? SUCC_WIN : SUCC_DRAW;
+        }
+        if (m.promotedTo != WQ && m.promotedTo != WR) return SUCC_DRAW;
+        for (const Move& r : replies) {
+            if (r.to == m.to) return SUCC_DRAW;
+        }
+        return SUCC_WIN;
+    }
+
+    if (m.moved == WK) wk = m.to;
+    else if (m.moved == BK) bk = m.to;
+    else pawn = m.to;
+    return index(wk, bk, pawn, b.isWhiteTurn);
+}
+
+// White to move wins if some move wins; black to move loses if every
+// move does. Positions still open when nothing changes are draws.
+static void solve(std::vector<uint8_t>& result,
+    const std::vector<uint32_t>& first, const std::vector<int32_t>& successors) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int idx = 0; idx < POSITIONS; ++idx) {
+            if (result[idx] != UNKNOWN) continue;
+
+            bool anyWin = false, anyDraw = false, allWin = true, allDraw = true;
+            for (uint32_t i = first[idx]; i < first[idx + 1]; ++i) {
+                int32_t s = successors[i];
+                uint8_t r = s == SUCC_WIN ? (uint8_t)WIN : s == SUCC_DRAW ? (uint8_t)DRAW : result[s];
+                anyWin |= r == WIN;
+                anyDraw |= r == DRAW;
+                allWin &= r == WIN;
+                allDraw &= r == DRAW;
+            }
+
+            uint8_t r = UNKNOWN;
+            if (idx & 1) r = anyWin ? WIN : allDraw ? DRAW : UNKNOWN;
+            else r = anyDraw ? DRAW : allWin ? WIN : UNKNOWN;
+
+            if (r != UNKNOWN) {
+                result[idx] = r;
+                changed = true;
+            }
+        }
+    }
+}
+
+static void build() {
+    std::vector<uint8_t> result(POSITIONS, UNKNOWN);
+    std::vector<uint32_t> first(POSITIONS + 1);
+    std::vector<int32_t> successors;
+    successors.reserve((size_t)POSITIONS * 6);
+
+    board b;
+    MoveGenerator generator;
+    std::vector<Move> moves, replies;
+
+    for (int idx = 0; idx < POSITIONS; ++idx) {
+        first[idx] = (uint32_t)successors.size();
+
+        int wk, bk, pawn;
+        bool whiteToMove;
+        decode(idx, wk, bk, pawn, whiteToMove);
+        if (!isValid(wk, bk, pawn, whiteToMove)) {
+            result[idx] = INVALID;
+            continue;
+        }
+
+        const Piece pieces[3] = { WK, BK, WP };
+        const int squares[3] = { wk, bk, pawn };
+        b.setPosition(pieces, squares, 3, whiteToMove);
+        generator.generateLegalMoves(b, moves);
+        if (moves.empty()) {
+            // white can only be stalemated; black is mated if in check
+            bool mated = !whiteToMove && generator.isSquareAttacked(b, bk, true);
+            result[idx] = mated ? WIN : DRAW;
+            continue;
+        }
+
+        for (const Move& m : moves) {
+            Unmove u = b.makeMove(m);
+            successors.push_back(successor(b, generator, m, wk, bk, pawn, replies));
+            b.unmakeMove(m, u);
+        }
+    }
+    first[POSITIONS] = (uint32_t)successors.size();
+
+    solve(result, first, successors);
+
+    for (int idx = 0; idx < POSITIONS; ++idx) {
+        if (result[idx] == WIN) bits[idx >> 3] |= (uint8_t)(1 << (idx & 7));
+    }
+}
+
+void init() {
+    std::call_once(built, build);
+}
+
+bool probe(int whiteKing, int blackKing, int pawn, bool whiteToMove) {
+    init();
+
+    // mirror the e-h files onto d-a
+    if (pawn % 8 > 3) {
+        whiteKing ^= 7;
+        blackKing ^= 7;
+        pawn ^= 7;
+    }
+    int idx = index(whiteKing, blackKing, pawn, whiteToMove);
+    return (bits[idx >> 3] >> (idx & 7)) & 1;
+}
+
+size_t tableBytes() {
+    return sizeof(bits);
+}
+
+// ---- Independent brute-force solver for verify() ----
+
+static const int KING_STEPS[8][2] = {
+    { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }
+};
+
+static int kingStep(int sq, int dir) {
+    int r = sq / 8 + KING_STEPS[dir][0], f = sq % 8 + KING_STEPS[dir][1];
+    return (r < 0 || r > 7 || f < 0 || f > 7) ? -1 : r * 8 + f;
+}
+
+// Does a queen (diagonals too) or rook on `from` attack sq? Only the white
+// king blocks: the black king is the one moving, so it never shields a
+// square behind itself.
+static bool sliderAttacks(int from, int sq, int wk, bool queen) {
+    for (int dir = 0; dir < 8; ++dir) {
+        bool diagonal = KING_STEPS[dir][0] != 0 && KING_STEPS[dir][1] != 0;
+        if (diagonal && !queen) continue;
+        for (int s = kingStep(from, dir); s >= 0; s = kingStep(s, dir)) {
+            if (s == sq) return true;
+            if (s == wk) break;
+        }
+    }
+    return false;
+}
+
+// White has just promoted on sq with black to move.
+static bool promotionWins(int wk, int bk, int sq, bool queen) {
+    if (adjacent(bk, sq) && !adjacent(wk, sq)) return false;   // taken at once
+
+    for (int dir = 0; dir < 8; ++dir) {
+        int to = kingStep(bk, dir);
+        if (to < 0 || to == sq || adjacent(to, wk)) continue;
+        if (!sliderAttacks(sq, to, wk, queen)) return true;     // black can move
+    }
+    // no moves: mate if in check, else stalemate
+    return sliderAttacks(sq, bk, wk, queen);
+}
+
+static uint8_t bruteForce(const std::vector<uint8_t>& result, int wk, int bk, int pawn, bool whiteToMove) {
+    if (whiteToMove) {
+        bool allDraw = true;
+
+        for (int dir = 0; dir < 8; ++dir) {
+            int to = kingStep(wk, dir);
+            if (to < 0 || to == pawn || adjacent(to, bk)) continue;
+            uint8_t r = result[index(to, bk, pawn, false)];
+            if (r == WIN) return WIN;
+            allDraw &= r == DRAW;
+        }
+
+        int ahead = pawn - 8;
+        if (ahead != wk && ahead != bk) {
+            if (ahead < 8) {
+                if (promotionWins(wk, bk, ahead, true) || promotionWins(wk, bk, ahead, false)) return WIN;
+            }
+            else {
+                uint8_t r = result[index(wk, bk, ahead, false)];
+                if (r == WIN) return WIN;
+                allDraw &= r == DRAW;
+
+                int twoAhead = ahead - 8;
+                if (pawn / 8 == 6 && twoAhead != wk && twoAhead != bk) {
+                    r = result[index(wk, bk, twoAhead, false)];
+                    if (r == WIN) return WIN;
+                    allDraw &= r == DRAW;
+                }
+            }
+        }
+        // with no moves at all allDraw stays set: stalemate
+        return allDraw ? DRAW : UNKNOWN;
+    }
+
+    bool hasMove = false, allWin = true;
+    for (int dir = 0; dir < 8; ++dir) {
+        int to = kingStep(bk, dir);
+        if (to < 0 || adjacent(to, wk) || pawnAttacks(pawn, to)) continue;
+        hasMove = true;
+        if (to == pawn) return DRAW;    // undefended pawn taken
+        uint8_t r = result[index(wk, to, pawn, true)];
+        if (r == DRAW) return DRAW;
+        allWin &= r == WIN;
+    }
+    if (!hasMove) return pawnAttacks(pawn, bk) ? WIN : DRAW;
+    return allWin ? WIN : UNKNOWN;
+}
+
+int verify() {
+    init();
+
+    std::vector<uint8_t> result(POSITIONS, UNKNOWN);
+    for (int idx = 0; idx < POSITIONS; ++idx) {
+        int wk, bk, pawn;
+        bool whiteToMove;
+        decode(idx, wk, bk, pawn, whiteToMove);
+        if (!isValid(wk, bk, pawn, whiteToMove)) result[idx] = INVALID;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int idx = 0; idx < POSITIONS; ++idx) {
+            if (result[idx] != UNKNOWN) continue;
+            int wk, bk, pawn;
+            bool whiteToMove;
+            decode(idx, wk, bk, pawn, whiteToMove);
+            uint8_t r = bruteForce(result, wk, bk, pawn, whiteToMove);
+            if (r != UNKNOWN) {
+                result[idx] = r;
+                changed = true;
+            }
+        }
+    }
+
+    int mismatches = 0;
+    for (int idx = 0; idx < POSITIONS; ++idx) {
+        if (result[idx] == INVALID) continue;
+        bool win = result[idx] == WIN;
+        bool stored = (bits[idx >> 3] >> (idx & 7)) & 1;
+        if (win != stored) ++mismatches;
+    }
+    return mismatches;
+}
+
+}
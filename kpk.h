@@ -0,0 +1,34 @@
+#ifndef KPK_H
+#define KPK_H
+
+#include <cstddef>
+
+// King and pawn versus king bitbase: one bit per position, set if the side
+// with the pawn wins. Built by retrograde analysis over MoveGenerator the
+// first time it is needed, then probed in O(1).
+//
+// The pawn is taken to be white and on files a-d (the other files mirror
+// onto them), ranks 2-7. Index: pawn square, white king, black king, side
+// to move = 24 * 64 * 64 * 2 bits = 24 KB.
+namespace Kpk {
+
+    static constexpr int PAWN_SQUARES = 24;
+    static constexpr int POSITIONS = PAWN_SQUARES * 64 * 64 * 2;
+
+    // Builds the table unless it's already built. Safe to call from any thread.
+    void init();
+
+    // Board squares (0 = a8) with a white pawn anywhere on ranks 2-7. A black
+    // pawn is probed by flipping the squares vertically (sq ^ 56) and
+    // swapping the colours. The position must be legal.
+    bool probe(int whiteKing, int blackKing, int pawn, bool whiteToMove);
+
+    // Solves every position again with a separate brute-force solver that
+    // steps the kings and pawn itself instead of using MoveGenerator.
+    // Returns the number of positions on which the two disagree.
+    int verify();
+
+    size_t tableBytes();
+}
+
+#endif // KPK_H
@@ -0,0 +1,23 @@
+#include "legalmovecache.h"
+
+void LegalMoveCache::update(board& Board, MoveGenerator& generator) {
+    if (valid && key == Board.zobristKey) return;
+
+    for (auto& moves : byOrigin) {
+        moves.clear();
+    }
+    for (const Move& m : generator.generateLegalMoves(Board)) {
+        byOrigin[m.from].push_back(m);
+    }
+
+    key = Board.zobristKey;
+    valid = true;
+}
+
+std::vector<Move> LegalMoveCache::movesBetween(int from, int to) const {
+    std::vector<Move> result;
+    for (const Move& m : byOrigin[from]) {
+        if (m.to == to) result.push_back(m);
+    }
+    return result;
+}
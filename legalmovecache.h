@@ -0,0 +1,31 @@
+#ifndef LEGALMOVECACHE_H
+#define LEGALMOVECACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+
+// Legal moves of one position, grouped by origin square. The GUI asks for
+// the moves of the selected piece, validates the destination and offers the
+// promotion choices from the same list, so the position is generated once.
+class LegalMoveCache
+{
+public:
+    // Regenerates only if Board is not the position already cached.
+    void update(board& Board, MoveGenerator& generator);
+    void invalidate() { valid = false; }
+
+    const std::vector<Move>& movesFrom(int sq) const { return byOrigin[sq]; }
+
+    // All moves from -> to: one, none, or the four promotions.
+    std::vector<Move> movesBetween(int from, int to) const;
+
+private:
+    std::vector<Move> byOrigin[64];
+    uint64_t key = 0;
+    bool valid = false;
+};
+
+#endif // LEGALMOVECACHE_H
@@ -1,4 +1,9 @@
 #include "mainwindow.h"
+#include "notation.h"
+#include "instrument.h"
+
+#include <QInputDialog>
+#include <QCoreApplication>
 
 
 MainWindow::MainWindow(QWidget* parent)
@@ -68,6 +73,9 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(undoBtn, &QPushButton::clicked, this, &MainWindow::undoMove);
     connect(redoBtn, &QPushButton::clicked, this, &MainWindow::redoMove);
+    connect(moveHistoryList, &QListWidget::itemClicked, this, [=](QListWidgetItem* item) {
+        jumpToPly(moveHistoryList->row(item) + 1);
+        });
 
     // ================================================================
     // CENTER PANEL (turn label + board with rank/file labels)
@@ -106,39 +114,14 @@ MainWindow::MainWindow(QWidget* parent)
     }
 
     // --- Actual chessboard ---
-    QWidget* boardWidget = new QWidget(this);
-    boardWidget->setFixedSize(640, 640);
-
-    QGridLayout* grid = new QGridLayout(boardWidget);
-    grid->setSpacing(0);
-    grid->setContentsMargins(0, 0, 0, 0);
-
-    const int SIZE = 8;
-    for (int row = 0; row < SIZE; ++row) {
-        for (int col = 0; col < SIZE; ++col) {
-
-            QPushButton* tile = new QPushButton(this);
-            QString color = ((row + col) % 2 == 0) ? "#EEEED2" : "#769656";
-            tile->setFixedSize(80, 80);
-
-            // FULL square chess-piece behavior (chess.com-like)
-            tile->setIconSize(QSize(80, 80));
-            tile->setStyleSheet(
-                "background-color:" + color +
-                "; border: none; padding: 0px; margin: 0px;"
-            );
-            grid->addWidget(tile, row, col);
-            boardButtons[row][col] = tile;
-
-            connect(tile, &QPushButton::clicked, this, [=]() {
-                selectedSquare = row * 8 + col;
-                handleTileClick();
-                });
-        }
-    }
+    boardView = new BoardWidget(this);
+    connect(boardView, &BoardWidget::squareClicked, this, [=](int sq) {
+        selectedSquare = sq;
+        handleTileClick();
+        });
 
     // Add board inside outer grid (row 07, col 18)
-    outerGrid->addWidget(boardWidget, 0, 1, 8, 8);
+    outerGrid->addWidget(boardView, 0, 1, 8, 8);
 
     centerPanel->addWidget(boardWithLabels, 0, Qt::AlignHCenter);
     centerPanel->addStretch();
@@ -164,8 +147,9 @@ MainWindow::MainWindow(QWidget* parent)
     // ================================================================
     //gameBoard.resetBoard();
     const std::string fen = "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
-    gameBoard.loadFEN(fen);
-    updateBoardUI();
+    loadPosition(fen);
+
+    book.open(QCoreApplication::applicationDirPath().toStdString() + "/book.bin");
 
     // Keyboard shortcuts
     QShortcut* undoShortcut = new QShortcut(QKeySequence("Ctrl+Z"), this);
@@ -199,45 +183,41 @@ void MainWindow::handleTileClick() {
         fromRow = selectedSquare / 8;
         fromCol = selectedSquare % 8;
 
-        boardButtons[fromRow][fromCol]->setStyleSheet("background-color: yellow; border: none;");
+        boardView->setSelectedSquare(selectedSquare);
 
-        auto moves = moveGenerator.generateLegalMoves(gameBoard);
-        std::vector<Move> mv;
-        for (auto i : moves) {
-            if (i.from == selectedSquare) {
-                mv.push_back(i);;
-            }
-        }
-        highlightMoves(mv);
+        legalMoves.update(gameBoard, moveGenerator);
+        boardView->setTargets(legalMoves.movesFrom(selectedSquare));
 
 
         return;
     }
 
     if (pieceSelected) {
-        bool valid = false;
         Move mv;
-        clearHighlights();
-        auto legalMoves = moveGenerator.generateLegalMoves(gameBoard);
-        for (auto &i : legalMoves) {
-            if (i.to == selectedSquare && i.from == gameBoard.toIndex(fromRow, fromCol)) {
-                mv = i;
-                valid = true;
-                break;
-            }
-        }
+        legalMoves.update(gameBoard, moveGenerator);
+        std::vector<Move> candidates = legalMoves.movesBetween(gameBoard.toIndex(fromRow, fromCol), selectedSquare);
+        bool valid = choosePromotion(candidates, mv);
 
-        resetColors();
+        clearSelection();
 
         if (valid) {
-            gameBoard.makeMove(mv);
+            history.push(gameBoard, mv);
+            legalMoves.invalidate();
             updateBoardUI();
             
         }
         if (valid) {
-            Move engineMove = engine.findBestMove(gameBoard, 2);
-            gameBoard.makeMove(engineMove);
-            updateBoardUI();
+            // the reply is undone and redone together with the user's move
+            Move engineMove;
+            if (!book.pickMove(gameBoard, moveGenerator, engineMove)) {
+                engineMove = engine.findBestMove(gameBoard, 2);
+            }
+            if (engineMove.from >= 0) {
+                history.push(gameBoard, engineMove, false);
+                legalMoves.invalidate();
+                updateBoardUI();
+            }
+            refreshHistoryList();
         }
         
 
@@ -248,135 +228,97 @@ void MainWindow::handleTileClick() {
 }
 
 void MainWindow::undoMove() {
-
+    if (!history.undo(gameBoard)) return;
+    jumpToPly(history.ply());
 }
 
 void MainWindow::redoMove() {
-
+    if (!history.redo(gameBoard)) return;
+    jumpToPly(history.ply());
 }
 
-void MainWindow::updateBoardUI() {
+void MainWindow::jumpToPly(int ply) {
+    // drop a half-made selection, it belongs to the old position
+    clearSelection();
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            int ind = gameBoard.toIndex(row, col);
-            Piece piece = gameBoard.currentState[ind];
-            QString iconPath;
-
-            switch (piece) {
-            case WP: iconPath = "images/white_pawn.png"; break;
-            case WR: iconPath = "images/white_rook.png"; break;
-            case WN: iconPath = "images/white_knight.png"; break;
-            case WB: iconPath = "images/white_bishop.png"; break;
-            case WQ: iconPath = "images/white_queen.png"; break;
-            case WK: iconPath = "images/white_king.png"; break;
-
-            case BP: iconPath = "images/black_pawn.png"; break;
-            case BR: iconPath = "images/black_rook.png"; break;
-            case BN: iconPath = "images/black_knight.png"; break;
-            case BB: iconPath = "images/black_bishop.png"; break;
-            case BQ: iconPath = "images/black_queen.png"; break;
-            case BK: iconPath = "images/black_king.png"; break;
-
-            default: iconPath = ""; break;
-            }
+    history.goToPly(gameBoard, ply);
+    legalMoves.invalidate();
+    updateBoardUI();
 
-            if (!iconPath.isEmpty()) {
-                QIcon icon(iconPath);
-                boardButtons[row][col]->setIcon(icon);
-                boardButtons[row][col]->setIconSize(boardButtons[row][col]->size());
-            }
-            else {
-                boardButtons[row][col]->setIcon(QIcon());
-            }
-        }
-    }
+    moveHistoryList->setCurrentRow(history.ply() - 1);
 }
 
-void MainWindow::resetColors()
-{
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            QString color = ((r + c) % 2 == 0) ? "#EEEED2" : "#769656";
-            boardButtons[r][c]->setStyleSheet("background-color:" + color + "; border: none;");
-        }
+void MainWindow::refreshHistoryList() {
+    // rows past the end belong to a line that was undone and overwritten
+    while (moveHistoryList->count() > history.size()) {
+        delete moveHistoryList->takeItem(moveHistoryList->count() - 1);
     }
-}
-
-void MainWindow::highlightMoves(std::vector<Move>& moves) {
-    clearHighlights();
 
-    for (auto& mv : moves) {
-        int square = mv.to;
-        int r = square / 8;
-        int c = square % 8;
-        QWidget* overlay = new QWidget(boardButtons[r][c]);
-        overlay->setAttribute(Qt::WA_TransparentForMouseEvents);
-        overlay->setGeometry(0, 0, 80, 80);
-
-        bool isCapture = (gameBoard.currentState[square] != EMPTY);
-
-        if (!isCapture) {
+    for (int i = moveHistoryList->count(); i < history.size(); ++i) {
+        const Move& m = history.at(i).move;
+        bool white = (m.moved >= WQ);
+        int moveNumber = startFullmove + (i + (startWhiteToMove ? 0 : 1)) / 2;
+        QString prefix = QString::number(moveNumber) + (white ? ". " : "... ");
+        moveHistoryList->addItem(prefix + QString::fromStdString(history.at(i).san));
+    }
 
-            QWidget* dot = new QWidget(overlay);
-            dot->setAttribute(Qt::WA_TransparentForMouseEvents);
+    moveHistoryList->setCurrentRow(history.ply() - 1);
+}
 
-            dot->setFixedSize(22, 22);                 // perfect dot size
-            dot->move((80 - 22) / 2, (80 - 22) / 2);   // perfectly centered
+void MainWindow::updateBoardUI() {
+    // the widget repaints only the squares that changed
+    boardView->setPosition(gameBoard.currentState);
+}
 
-            dot->setStyleSheet(
-                "background-color: rgba(0,0,0,50);"     // translucent black
-                "border-radius: 11px;"                  // circle
-                "border: none;"
-            );
+void MainWindow::loadPosition(const std::string& fen) {
+    clearSelection();
 
-            dot->show();
-        }
-        else {
-            // ---- Capture Move: Even translucent ring ----
-            overlay->setStyleSheet("background-color: transparent;");
-            overlay->setFixedSize(80, 80);
-            overlay->move(0, 0);
-
-            // Custom paint event for clean ring
-            overlay->installEventFilter(this);
-        }
+    gameBoard.loadFEN(fen);
+    history.clear();
+    legalMoves.invalidate();
 
-        overlay->show();
-        highlightOverlays.push_back(overlay);
-    }
+    startFullmove = gameBoard.fullmoveNumber;
+    startWhiteToMove = gameBoard.isWhiteTurn;
+    moveHistoryList->clear();
+    updateBoardUI();
 }
 
-void MainWindow::clearHighlights() {
-    for (auto* w : highlightOverlays) {
-        w->deleteLater();
+bool MainWindow::choosePromotion(std::vector<Move>& candidates, Move& chosen) {
+    if (candidates.empty()) return false;
+    if (candidates.size() == 1) {
+        chosen = candidates[0];
+        return true;
     }
-    highlightOverlays.clear();
-}
 
-bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
-    if (event->type() == QEvent::Paint) {
-        QWidget* w = qobject_cast<QWidget*>(obj);
-        if (!w) return false;
-
-        QPainter p(w);
-        p.setRenderHint(QPainter::Antialiasing, true);
-
-        int outerRadius = 70;
-        int innerRadius = 58;
+    // several moves between the same squares only happen for promotions;
+    // list them queen first so the default choice is the usual one
+    static const Piece ORDER[4][2] = { { WQ, BQ }, { WR, BR }, { WB, BB }, { WN, BN } };
+    static const char* NAMES[4] = { "Queen", "Rook", "Bishop", "Knight" };
+
+    std::vector<Move> ordered;
+    QStringList names;
+    for (int i = 0; i < 4; ++i) {
+        for (const Move& m : candidates) {
+            if (m.promotedTo == ORDER[i][0] || m.promotedTo == ORDER[i][1]) {
+                ordered.push_back(m);
+                names << NAMES[i];
+            }
+        }
+    }
+    candidates = ordered;
 
-        QPoint center(w->width() / 2, w->height() / 2);
+    bool ok = false;
+    QString picked = QInputDialog::getItem(this, "Promotion", "Promote to:", names, 0, false, &ok);
+    if (!ok) return false;
 
-        // Outer circle (translucent)
-        QPen pen(QColor(0, 0, 0, 50));
-        pen.setWidth(6);
-        p.setPen(pen);
-        p.setBrush(Qt::NoBrush);
+    chosen = candidates[names.indexOf(picked)];
+    return true;
+}
 
-        // Draw smooth ring
-        p.drawEllipse(center, outerRadius / 2, outerRadius / 2);
-    }
-    return false;
+void MainWindow::clearSelection() {
+    boardView->setSelectedSquare(-1);
+    boardView->setTargets({});
+    pieceSelected = false;
 }
 
 void MainWindow::CalculateMoves() {
@@ -385,6 +327,7 @@ void MainWindow::CalculateMoves() {
     int depth = 5;  // change as needed
     board b = gameBoard;
 
+    Instrument::reset();
     auto start = std::chrono::high_resolution_clock::now();
 
     long long nodes = perft(depth, b);
@@ -394,6 +337,9 @@ void MainWindow::CalculateMoves() {
 
     qDebug() << "Perft(" << depth << ") nodes:" << nodes;
     qDebug() << "Time:" << elapsed.count() << "seconds";
+    if (Instrument::enabled()) {
+        qDebug().noquote() << QString::fromStdString(Instrument::toJson(Instrument::aggregate()));
+    }
 }
 
 long long MainWindow::perft(int depth, board& b) {
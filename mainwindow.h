@@ -7,6 +7,7 @@
 #include "movegenerator.h"
 
 #include <QMainWindow>
+#include <QDebug>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -14,10 +15,15 @@
 #include <QShortcut>
 #include <QListWidget>
 #include <QPainter>
+#include <QPixmap>
 #include <QPen>
 #include <chrono>
 #include <string>
 #include "engine.h"
+#include "gamehistory.h"
+#include "boardwidget.h"
+#include "legalmovecache.h"
+#include "openingbook.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -38,13 +44,13 @@ public:
 private:
     void handleTileClick();
     void updateBoardUI();
-    void resetColors();
     void undoMove();
     void redoMove();
-    void highlightMoves(std::vector<Move>& moves);
-    std::vector<QWidget*> highlightOverlays;
-    void clearHighlights();
-    bool eventFilter(QObject* obj, QEvent* event);
+    void jumpToPly(int ply);
+    void refreshHistoryList();
+    void clearSelection();
+    void loadPosition(const std::string& fen);
+    bool choosePromotion(std::vector<Move>& candidates, Move& chosen);
 
     void CalculateMoves();
     long long perft(int depth, board& b);
@@ -54,16 +60,21 @@ private:
 private:
 
     Ui::mainwindowClass ui;
-    QPushButton* boardButtons[8][8];  // 2D grid of buttons
+    BoardWidget* boardView = nullptr;
     QLabel* turnLabel = NULL;
     QListWidget* moveHistoryList = nullptr;
 
 
     board gameBoard;
+    GameHistory history;
+    int startFullmove = 1;          // numbering of the move list
+    bool startWhiteToMove = true;
     MoveGenerator moveGenerator;
+    LegalMoveCache legalMoves;      // moves of gameBoard, by origin square
     int selectedSquare;
     bool pieceSelected = false;
 
     Engine engine;
+    OpeningBook book;       // book.bin next to the executable, if there is one
 
 };
\ No newline at end of file
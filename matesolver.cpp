@@ -0,0 +1,306 @@
+#include "matesolver.h"
+
+#include <algorithm>
+#include <chrono>
+
+MateSolver::MateSolver(size_t megabytes) {
+    resize(megabytes);
+}
+
+void MateSolver::resize(size_t mb) {
+    if (mb < 1) mb = 1;
+
+    // whole buckets, a power of two of them so the index is a mask
+    size_t buckets = (mb * 1024 * 1024) / (sizeof(Entry) * BUCKET);
+    size_t pow2 = 1;
+    while (pow2 * 2 <= buckets) pow2 *= 2;
+
+    table.reset(new Entry[pow2 * BUCKET]);
+    entryCount = pow2 * BUCKET;
+    clear();
+}
+
+void MateSolver::clear() {
+    std::fill(table.get(), table.get() + entryCount, Entry());
+    usedCount = 0;
+}
+
+// ---- Table ----
+
+static inline size_t bucketIndex(uint64_t key, int depth, size_t entryCount, size_t bucket) {
+    uint64_t h = key ^ ((uint64_t)depth * 0x9E3779B97F4A7C15ull);
+    return (size_t)(h & (entryCount / bucket - 1)) * bucket;
+}
+
+MateSolver::Node MateSolver::lookup(uint64_t key, int depth) const {
+    const Entry* bucket = &table[bucketIndex(key, depth, entryCount, BUCKET)];
+    for (size_t i = 0; i < BUCKET; ++i) {
+        const Entry& e = bucket[i];
+        if (e.used && e.key == key && e.depth == depth) {
+            Node n;
+            n.pn = e.pn;
+            n.dn = e.dn;
+            n.mate = e.mate;
+            return n;
+        }
+    }
+    return Node();
+}
+
+void MateSolver::store(uint64_t key, int depth, const Node& n, uint64_t work) {
+    Entry* bucket = &table[bucketIndex(key, depth, entryCount, BUCKET)];
+    Entry* slot = nullptr;
+    for (size_t i = 0; i < BUCKET && !slot; ++i) {
+        if (bucket[i].used && bucket[i].key == key && bucket[i].depth == depth) {
+            // df-pn comes back to a node many times: its cost is the sum
+            slot = &bucket[i];
+            work += slot->work;
+        }
+    }
+
+    for (int attempt = 0; attempt < 2 && !slot; ++attempt) {
+        for (size_t i = 0; i < BUCKET && !slot; ++i) {
+            if (!bucket[i].used) slot = &bucket[i];
+        }
+        if (slot) ++usedCount;
+        else if (attempt == 0 && usedCount >= entryCount / 2) collect();
+    }
+
+    if (!slot) {
+        // a crowded bucket in a table that isn't full yet: evict the
+        // entry that was cheapest to compute
+        slot = bucket;
+        for (size_t i = 1; i < BUCKET; ++i) {
+            if (bucket[i].work < slot->work) slot = &bucket[i];
+        }
+    }
+
+    slot->key = key;
+    slot->pn = n.pn;
+    slot->dn = n.dn;
+    slot->work = (uint32_t)std::min<uint64_t>(work, 0xFFFFFFFF);
+    slot->mate = (uint16_t)n.mate;
+    slot->depth = (uint8_t)depth;
+    slot->used = 1;
+}
+
+// Frees entries whose subtrees took less work than the median. Proven and
+// disproven entries go first; unresolved ones only if that freed too little.
+void MateSolver::collect() {
+    std::vector<uint32_t> sample;
+    size_t step = std::max<size_t>(1, entryCount / 65536);
+    for (size_t i = 0; i < entryCount; i += step) {
+        if (table[i].used) sample.push_back(table[i].work);
+    }
+    if (sample.empty()) return;
+    std::nth_element(sample.begin(), sample.begin() + sample.size() / 2, sample.end());
+    uint32_t threshold = sample[sample.size() / 2];
+
+    size_t before = usedCount;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < entryCount; ++i) {
+            Entry& e = table[i];
+            bool resolved = e.pn == 0 || e.dn == 0;
+            if (e.used && e.work <= threshold && resolved == (pass == 0)) {
+                e.used = 0;
+                --usedCount;
+            }
+        }
+        if (before - usedCount >= before / 4) break;
+    }
+    ++collections;
+}
+
+// ---- Search ----
+
+bool MateSolver::givesCheck() {
+    // called after the move: the side to move is the one that may be in check
+    int king = generator.findKing(Board, Board.isWhiteTurn);
+    return king >= 0 && generator.isSquareAttacked(Board, king, !Board.isWhiteTurn);
+}
+
+void MateSolver::search(int ply, int depth, uint32_t thpn, uint32_t thdn) {
+    long long startNodes = nodes++;
+    uint64_t key = Board.zobristKey;
+    bool orNode = (ply & 1) == 0;   // the attacker moves at even plies
+
+    std::vector<Move>& moves = moveStack[ply];
+    std::vector<uint64_t>& keys = keyStack[ply];
+    generator.generateLegalMoves(Board, moves);
+
+    Node n;
+    if (moves.empty()) {
+        int king = generator.findKing(Board, Board.isWhiteTurn);
+        bool mated = !orNode && generator.isSquareAttacked(Board, king, !Board.isWhiteTurn);
+        n.pn = mated ? 0 : INF;
+        n.dn = mated ? INF : 0;
+        store(key, depth, n, 1);
+        return;
+    }
+    if (depth == 0) {
+        // out of moves for the attacker, or the defender isn't mated
+        n.pn = INF;
+        n.dn = 0;
+        store(key, depth, n, 1);
+        return;
+    }
+
+    keys.clear();
+    size_t kept = 0;
+    for (const Move& m : moves) {
+        Unmove u = Board.makeMove(m);
+        if (!orNode || !checksOnly || givesCheck()) {
+            moves[kept++] = m;
+            keys.push_back(Board.zobristKey);
+        }
+        Board.unmakeMove(m, u);
+    }
+    moves.resize(kept);
+    if (moves.empty()) {
+        n.pn = INF;
+        n.dn = 0;
+        store(key, depth, n, 1);
+        return;
+    }
+
+    for (;;) {
+        // OR node: proved by its easiest child, refuted by all of them;
+        // AND node the other way round
+        uint64_t sum = 0;
+        uint32_t best = INF, second = INF;
+        size_t bestChild = 0;
+        int mate = orNode ? 0xFFFF : 0;
+        Node bestNode;
+
+        for (size_t i = 0; i < moves.size(); ++i) {
+            Node c = lookup(keys[i], depth - 1);
+            uint32_t select = orNode ? c.pn : c.dn;
+            sum += orNode ? c.dn : c.pn;
+
+            if (select < best) {
+                second = best;
+                best = select;
+                bestChild = i;
+                bestNode = c;
+            }
+            else if (select < second) {
+                second = select;
+            }
+
+            if (orNode && c.pn == 0) mate = std::min(mate, c.mate + 1);
+            if (!orNode) mate = std::max(mate, c.mate + 1);
+        }
+
+        uint32_t total = (uint32_t)std::min<uint64_t>(sum, INF);
+        n.pn = orNode ? best : total;
+        n.dn = orNode ? total : best;
+        n.mate = n.pn == 0 ? mate : 0;
+
+        if (n.pn >= thpn || n.dn >= thdn) break;
+        if (stopFlag.load(std::memory_order_relaxed) || (maxNodes > 0 && nodes >= maxNodes)) break;
+
+        // the child may use up the slack of this node's thresholds, and
+        // must come back once it is no longer the best choice
+        uint32_t childPn, childDn;
+        if (orNode) {
+            childPn = std::min<uint64_t>(thpn, (uint64_t)second + 1);
+            childDn = (uint32_t)std::min<uint64_t>(INF, (uint64_t)thdn - n.dn + bestNode.dn);
+        }
+        else {
+            childDn = std::min<uint64_t>(thdn, (uint64_t)second + 1);
+            childPn = (uint32_t)std::min<uint64_t>(INF, (uint64_t)thpn - n.pn + bestNode.pn);
+        }
+
+        const Move m = moves[bestChild];
+        Unmove u = Board.makeMove(m);
+        search(ply + 1, depth - 1, childPn, childDn);
+        Board.unmakeMove(m, u);
+    }
+
+    store(key, depth, n, nodes - startNodes);
+}
+
+// Walks the proof from the root: the attacker's quickest mate, the
+// defender's longest resistance. Parts of the proof the table has lost
+// to collection are searched again.
+void MateSolver::extractLine(int depth, std::vector<Move>& line) {
+    board root = Board;
+    std::vector<Move> moves;
+
+    for (int ply = 0; ply <= depth; ++ply) {
+        int remaining = depth - ply;
+        bool orNode = (ply & 1) == 0;
+        if (lookup(Board.zobristKey, remaining).pn != 0) {
+            search(ply, remaining, INF, INF);
+            if (lookup(Board.zobristKey, remaining).pn != 0) break;
+        }
+
+        generator.generateLegalMoves(Board, moves);
+        if (moves.empty() || remaining == 0) break;     // mated
+
+        // every defence is needed, but only one attacking move: that side
+        // searches again only if no proven move is left in the table
+        bool found = false;
+        Move chosen;
+        int chosenMate = 0;
+        for (int pass = orNode ? 0 : 1; pass < 2 && !found; ++pass) {
+            for (const Move& m : moves) {
+                Unmove u = Board.makeMove(m);
+                if (!orNode || !checksOnly || givesCheck()) {
+                    Node c = lookup(Board.zobristKey, remaining - 1);
+                    if (c.pn != 0 && pass == 1) {
+                        search(ply + 1, remaining - 1, INF, INF);
+                        c = lookup(Board.zobristKey, remaining - 1);
+                    }
+                    bool better = orNode ? c.mate < chosenMate : c.mate > chosenMate;
+                    if (c.pn == 0 && (!found || better)) {
+                        found = true;
+                        chosen = m;
+                        chosenMate = c.mate;
+                    }
+                }
+                Board.unmakeMove(m, u);
+            }
+        }
+        if (!found) break;
+
+        line.push_back(chosen);
+        Board.makeMove(chosen);
+    }
+
+    Board = root;
+}
+
+MateResult MateSolver::solve(const board& root, int moves, bool onlyChecks, long long nodeLimit) {
+    auto start = std::chrono::steady_clock::now();
+    MateResult result;
+
+    clear();
+    Board = root;
+    checksOnly = onlyChecks;
+    nodes = 0;
+    maxNodes = nodeLimit;
+    collections = 0;
+    stopFlag.store(false, std::memory_order_relaxed);
+
+    int depth = std::max(1, std::min(moves, 127)) * 2 - 1;
+    moveStack.resize(depth + 1);
+    keyStack.resize(depth + 1);
+
+    search(0, depth, INF, INF);
+
+    Node r = lookup(Board.zobristKey, depth);
+    if (r.pn == 0) {
+        result.status = MateResult::MATE;
+        result.plies = r.mate;
+        extractLine(depth, result.line);
+    }
+    else if (r.dn == 0) {
+        result.status = MateResult::NO_MATE;
+    }
+
+    result.nodes = nodes;
+    result.collections = collections;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,99 @@
+#ifndef MATESOLVER_H
+#define MATESOLVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+
+struct MateResult {
+    enum Status { MATE, NO_MATE, UNKNOWN };
+
+    Status status = UNKNOWN;
+    int plies = 0;              // length of line when status == MATE
+    std::vector<Move> line;     // attacker's moves and the longest defence
+    long long nodes = 0;
+    double seconds = 0.0;
+    int collections = 0;        // garbage collections of the table
+};
+
+// Mate-in-N solver using depth-first proof-number search (df-pn). The side
+// to move is the attacker: it needs one move that mates (OR node), the
+// defender must be mated after every reply (AND node). Each node carries a
+// proof number (how many leaves still have to be proved to show a mate) and
+// a disproof number (how many to refute it), and the search always expands
+// the most proving node under thresholds passed down the tree, so only the
+// path to it is kept on the stack.
+//
+// Results live in a fixed-size table keyed on the Zobrist key and the
+// remaining depth. When it fills up, entries whose subtrees took little
+// work are collected, resolved (proven or disproven) ones first, since
+// they are cheap to find again.
+class MateSolver
+{
+public:
+    explicit MateSolver(size_t megabytes = 64);
+
+    void resize(size_t megabytes);
+    void clear();
+
+    // Looks for a mate in at most moves moves of the side to move. With
+    // checksOnly the attacker only considers checking moves. maxNodes = 0
+    // searches until the question is settled or stop() is called. The mate
+    // found is not necessarily the shortest; the line follows the quickest
+    // proof the table knows of.
+    MateResult solve(const board& root, int moves, bool checksOnly = false, long long maxNodes = 0);
+
+    // May be called from another thread.
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t INF = 0x3FFFFFFF;
+    static constexpr size_t BUCKET = 4;
+
+    struct Entry {
+        uint64_t key;
+        uint32_t pn, dn;
+        uint32_t work;      // nodes expanded below this one, saturating
+        uint16_t mate;      // plies to mate once proven
+        uint8_t depth;      // remaining plies
+        uint8_t used;
+    };
+
+    struct Node {
+        uint32_t pn = 1, dn = 1;
+        int mate = 0;
+    };
+
+    Node lookup(uint64_t key, int depth) const;
+    void store(uint64_t key, int depth, const Node& n, uint64_t work);
+    void collect();
+
+    // Expands Board until its proof number reaches thpn or its disproof
+    // number thdn, and stores the result.
+    void search(int ply, int depth, uint32_t thpn, uint32_t thdn);
+    bool givesCheck();
+    void extractLine(int depth, std::vector<Move>& line);
+
+    std::unique_ptr<Entry[]> table;
+    size_t entryCount = 0;
+    size_t usedCount = 0;
+    int collections = 0;
+
+    board Board;
+    MoveGenerator generator;
+    bool checksOnly = false;
+    long long nodes = 0;
+    long long maxNodes = 0;
+    std::atomic<bool> stopFlag{ false };
+
+    // per ply: the node's moves and the keys of the positions they lead to
+    std::vector<std::vector<Move>> moveStack;
+    std::vector<std::vector<uint64_t>> keyStack;
+};
+
+#endif // MATESOLVER_H
@@ -0,0 +1,139 @@
+#include "mlencoder.h"
+#include "movegenerator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace MlEncoder {
+
+int policyIndex(const Move& m) {
+    bool under = m.wasPromotion && m.promotedTo != WQ && m.promotedTo != BQ;
+    if (!under) return m.from * 64 + m.to;
+
+    int colour = (m.moved >= WQ) ? 0 : 1;
+    int file = m.from % 8;
+    int dir = (m.to % 8) - file + 1;
+    int piece = 0;
+    switch (m.promotedTo) {
+    case WB: case BB: piece = 1; break;
+    case WR: case BR: piece = 2; break;
+    default: piece = 0; break;
+    }
+    return 4096 + ((colour * 8 + file) * 3 + dir) * 3 + piece;
+}
+
+// Plane of each Piece, -1 for EMPTY.
+static constexpr int PIECE_PLANE[13] = {
+    -1,
+    6, 7, 8, 9, 10, 11,
+    0, 1, 2, 3, 4, 5
+};
+
+static void encodeWith(MoveGenerator& generator, std::vector<Move>& legal,
+    board& Board, uint64_t* mask, float* planes)
+{
+    if (mask) {
+        std::memset(mask, 0, MASK_WORDS * sizeof(uint64_t));
+        generator.generateLegalMoves(Board, legal);
+        for (const Move& m : legal) {
+            int idx = policyIndex(m);
+            mask[idx >> 6] |= 1ULL << (idx & 63);
+        }
+    }
+
+    if (planes) {
+        std::memset(planes, 0, PLANE_FLOATS * sizeof(float));
+        for (int sq = 0; sq < 64; ++sq) {
+            int plane = PIECE_PLANE[Board.currentState[sq]];
+            if (plane >= 0) planes[plane * 64 + sq] = 1.0f;
+        }
+        if (Board.isWhiteTurn) {
+            std::fill(planes + 12 * 64, planes + 13 * 64, 1.0f);
+        }
+        for (int bit = 0; bit < 4; ++bit) {
+            if (Board.castleRights & (1 << bit)) {
+                std::fill(planes + (13 + bit) * 64, planes + (14 + bit) * 64, 1.0f);
+            }
+        }
+        if (Board.hasEnPassant && Board.enPassantSquare >= 0) {
+            planes[17 * 64 + Board.enPassantSquare] = 1.0f;
+        }
+    }
+}
+
+void encode(board& Board, uint64_t* mask, float* planes) {
+    MoveGenerator generator;
+    std::vector<Move> legal;
+    encodeWith(generator, legal, Board, mask, planes);
+}
+
+// boardAt(i) gives the i-th board of either batch layout.
+template <typename BoardAt>
+static void encodeRange(BoardAt boardAt, size_t count, uint64_t* masks, float* planes, int threads) {
+    if (count == 0) return;
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    if ((size_t)threads > count) threads = (int)count;
+
+    // contiguous slices keep each thread's writes on its own cache lines
+    auto work = [=](size_t begin, size_t end) {
+        MoveGenerator generator;
+        std::vector<Move> legal;
+        legal.reserve(256);
+
+        for (size_t i = begin; i < end; ++i) {
+            encodeWith(generator, legal, boardAt(i),
+                masks ? masks + i * MASK_WORDS : nullptr,
+                planes ? planes + i * PLANE_FLOATS : nullptr);
+        }
+    };
+
+    // an exception stays on the thread that threw it until every thread
+    // has been joined, then the first one is rethrown
+    std::vector<std::exception_ptr> errors((size_t)threads);
+    auto guardedWork = [&](int t, size_t begin, size_t end) {
+        try {
+            work(begin, end);
+        }
+        catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    size_t slice = (count + threads - 1) / threads;
+    int started = 1;
+    try {
+        for (; started < threads && started * slice < count; ++started) {
+            size_t begin = started * slice;
+            pool.emplace_back(guardedWork, started, begin, std::min(count, begin + slice));
+        }
+    }
+    catch (const std::system_error&) {
+        // out of threads: the slices not started run here
+    }
+    guardedWork(0, 0, std::min(count, slice));
+    for (int t = started; t < threads && t * slice < count; ++t) {
+        guardedWork(t, t * slice, std::min(count, t * slice + slice));
+    }
+
+    for (auto& th : pool) {
+        th.join();
+    }
+    for (const std::exception_ptr& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
+
+void encodeBatch(board* boards, size_t count, uint64_t* masks, float* planes, int threads) {
+    encodeRange([boards](size_t i) -> board& { return boards[i]; }, count, masks, planes, threads);
+}
+
+void encodeBatch(board* const* boards, size_t count, uint64_t* masks, float* planes, int threads) {
+    encodeRange([boards](size_t i) -> board& { return *boards[i]; }, count, masks, planes, threads);
+}
+
+} // namespace MlEncoder
@@ -0,0 +1,50 @@
+#ifndef MLENCODER_H
+#define MLENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "board.h"
+
+// Encodes positions for neural-network training: a legal-move mask over a
+// fixed policy index space and a stack of 8x8 input planes, written straight
+// into caller-allocated flat arrays.
+//
+// Policy index space, squares as in board (0 = a8, 63 = h1):
+//   [0, 4096)      from * 64 + to; queen promotions use this form too
+//   [4096, 4240)   under-promotions: 4096 + ((colour * 8 + file) * 3 + dir) * 3 + piece
+//                  colour 0 = white, 1 = black, file of the pawn,
+//                  dir 0 = capture towards a-file, 1 = push, 2 = towards h-file,
+//                  piece 0 = knight, 1 = bishop, 2 = rook
+//
+// Input planes, each 64 floats in square order:
+//   0-5    white Q, R, P, N, K, B (Piece order)
+//   6-11   black Q, R, P, N, K, B
+//   12     side to move (all ones if white)
+//   13-16  castling rights: white king side, white queen side, black king side, black queen side
+//   17     en-passant target square
+namespace MlEncoder {
+
+constexpr int POLICY_SIZE = 4096 + 144;
+constexpr int MASK_WORDS = (POLICY_SIZE + 63) / 64;    // uint64_t words per position
+constexpr int PLANE_COUNT = 18;
+constexpr int PLANE_FLOATS = PLANE_COUNT * 64;         // floats per position
+
+int policyIndex(const Move& m);
+
+// Encodes one position. Board is used for make/unmake but left unchanged.
+// Either output may be null.
+void encode(board& Board, uint64_t* mask, float* planes);
+
+// Encodes boards[0..count) into masks[i * MASK_WORDS] and
+// planes[i * PLANE_FLOATS] on up to threads threads (0 = all cores). Each
+// board is only touched by one thread. Nothing is allocated per position.
+// Slices whose thread can't be started run on the calling thread; an
+// exception from any slice is rethrown once every thread has joined.
+void encodeBatch(board* boards, size_t count, uint64_t* masks, float* planes, int threads = 0);
+// Same for boards that are not stored contiguously.
+void encodeBatch(board* const* boards, size_t count, uint64_t* masks, float* planes, int threads = 0);
+
+} // namespace MlEncoder
+
+#endif // MLENCODER_H
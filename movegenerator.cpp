@@ -1,4 +1,9 @@
 ﻿#include "movegenerator.h"
+#include "compactboard.h"
+#include "bitops.h"
+#include "instrument.h"
+
+#include <algorithm>
 
 static constexpr int KNIGHT_DELTAS[8][2] = {
     { 2, 1}, { 2,-1}, {-2, 1}, {-2,-1},
@@ -30,6 +35,22 @@ MoveGenerator::MoveGenerator() {
 std::vector<Move> MoveGenerator::generatePseudoLegalMoves(board& Board) {
     std::vector<Move> moves;
     moves.reserve(96);
+    generatePseudoLegalMoves(Board, moves);
+    return moves;
+}
+
+void MoveGenerator::generatePseudoLegalMoves(board& Board, std::vector<Move>& moves) {
+    pseudoLegalMoves(Board, moves);
+}
+
+void MoveGenerator::generatePseudoLegalMoves(const CompactBoard& Board, std::vector<Move>& moves) {
+    pseudoLegalMoves(Board, moves);
+}
+
+template <class Position>
+void MoveGenerator::pseudoLegalMoves(Position& Board, std::vector<Move>& moves) {
+    INSTRUMENT_SCOPE(TIME_PSEUDO_LEGAL_MOVES);
+    moves.clear();
 
     // Iterate over all squares on the board
     for (int i = 0; i < 64; ++i) {
@@ -89,11 +110,12 @@ std::vector<Move> MoveGenerator::generatePseudoLegalMoves(board& Board) {
         }
     }
 
-    return moves;
+    INSTRUMENT_ADD(PSEUDO_LEGAL_MOVES, moves.size());
 }
 
 // Knight move generation
-void MoveGenerator::generateKnightMoves(board& Board, int i, Piece knightType, std::vector<Move>& moves) {
+template <class Position>
+void MoveGenerator::generateKnightMoves(Position& Board, int i, Piece knightType, std::vector<Move>& moves) {
     
 
     int row = i / 8;
@@ -145,7 +167,8 @@ void MoveGenerator::generateKnightMoves(board& Board, int i, Piece knightType, s
 }
 
 // Function to generate moves for sliding pieces: rook, bishop, and queen
-void MoveGenerator::generateSlidingMoves(board& Board, int i, Piece piece, std::vector<Move>& moves) {
+template <class Position>
+void MoveGenerator::generateSlidingMoves(Position& Board, int i, Piece piece, std::vector<Move>& moves) {
     int row = i / 8;
     int col = i % 8;
 
@@ -364,7 +387,8 @@ void MoveGenerator::generateSlidingMoves(board& Board, int i, Piece piece, std::
     }
 }
 
-void MoveGenerator::generateKingMoves(board& Board, int i, Piece kingType, std::vector<Move>& moves) {
+template <class Position>
+void MoveGenerator::generateKingMoves(Position& Board, int i, Piece kingType, std::vector<Move>& moves) {
     int row = i / 8;
     int col = i % 8;
     for (int d = 0; d < 8; ++d) {
@@ -387,7 +411,7 @@ void MoveGenerator::generateKingMoves(board& Board, int i, Piece kingType, std::
                     moves.emplace_back(i, newIndex, kingType, EMPTY, castle);
                 }
             }
-            if (kingType == WK && Board.isBlackPiece(targetPiece)) {
+            if (kingType == WK && isBlackPiece(targetPiece)) {
                 int castle = 0b1100;
                 castle = castle & Board.castleRights;
                 if (targetPiece == BR && newIndex == 0) {
@@ -425,7 +449,8 @@ void MoveGenerator::generateKingMoves(board& Board, int i, Piece kingType, std::
     }
 }
 
-void MoveGenerator::generateCastlingMoves(board& Board, int i, Piece kingType, std::vector<Move>& moves) {
+template <class Position>
+void MoveGenerator::generateCastlingMoves(Position& Board, int i, Piece kingType, std::vector<Move>& moves) {
 
     if (kingType == WK) {
         if ((Board.castleRights & 0b0011) == 0) {
@@ -479,7 +504,8 @@ void MoveGenerator::generateCastlingMoves(board& Board, int i, Piece kingType, s
     }
 }
 
-void MoveGenerator::generatePawnMoves(board& Board, int i, Piece pawnType, std::vector<Move>& moves)
+template <class Position>
+void MoveGenerator::generatePawnMoves(Position& Board, int i, Piece pawnType, std::vector<Move>& moves)
 {
     int row = i / 8;
     int col = i % 8;
@@ -495,7 +521,7 @@ void MoveGenerator::generatePawnMoves(board& Board, int i, Piece pawnType, std::
     // -------------------------------
     if (row == promoRank)
     {
-        int oneForward = Board.toIndex(row + forward, col);
+        int oneForward = toIndex(row + forward, col);
 
         // forward promotion
         if (Board.currentState[oneForward] == EMPTY)
@@ -516,7 +542,7 @@ void MoveGenerator::generatePawnMoves(board& Board, int i, Piece pawnType, std::
             int cc = capCols[c];
             if (cc < 0 || cc > 7) continue;
 
-            int capIndex = Board.toIndex(row + forward, cc);
+            int capIndex = toIndex(row + forward, cc);
             Piece target = Board.currentState[capIndex];
             if (target == EMPTY) continue;
 
@@ -649,8 +675,13 @@ bool MoveGenerator::canCaptureKing(board& Board) {
 
 bool MoveGenerator::canCastle(board& Board, const Move& move) {
     // Board.isWhiteTurn here is the *opponent* (you flipped before calling)
-    bool enemyWhite = Board.isWhiteTurn;
+    return castlingPathSafe(Board, move, Board.isWhiteTurn);
+}
 
+// False if the king stands on, passes or lands on a square attacked by
+// the enemyWhite side.
+template <class Position>
+bool MoveGenerator::castlingPathSafe(const Position& Board, const Move& move, bool enemyWhite) {
     int from = move.from;
     int mid = -1;
     int to = move.to;
@@ -660,49 +691,313 @@ bool MoveGenerator::canCastle(board& Board, const Move& move) {
     else if (to == 62) mid = 61;  // white O-O: e1 -> g1
     else if (to == 58) mid = 59;  // white O-O-O: e1 -> c1
 
+    INSTRUMENT_COUNT(CAN_CASTLE_CALLS);
+
     // King cannot be in check on from, through, or to squares
-    if (isSquareAttacked(Board, from, enemyWhite)) return false;
-    if (isSquareAttacked(Board, mid, enemyWhite)) return false;
-    if (isSquareAttacked(Board, to, enemyWhite)) return false;
+    if (isSquareAttacked(Board, from, enemyWhite) || isSquareAttacked(Board, mid, enemyWhite)
+        || isSquareAttacked(Board, to, enemyWhite)) {
+        INSTRUMENT_COUNT(CAN_CASTLE_REJECTED);
+        return false;
+    }
 
     return true;
 }
 
 
 std::vector<Move> MoveGenerator::generateLegalMoves(board& Board) {
-    std::vector<Move> pseudoLegal = generatePseudoLegalMoves(Board);
     std::vector<Move> legal;
+    generateLegalMoves(Board, legal);
+    return legal;
+}
+
+void MoveGenerator::generateLegalMoves(board& Board, std::vector<Move>& legal) {
+    INSTRUMENT_SCOPE(TIME_LEGAL_MOVES);
+    INSTRUMENT_COUNT(LEGAL_GENERATIONS);
+
+    // pseudoLegal is a member so that repeated calls reuse its capacity
+    generatePseudoLegalMoves(Board, pseudoLegal);
+    legal.clear();
     legal.reserve(pseudoLegal.size());
 
     for (auto& i : pseudoLegal) {
+        if (isLegal(Board, i)) {
+            legal.push_back(i);
+        }
+    }
 
-        // --- Castling legality check ---
-        if (i.wasCastling) {
-            Board.isWhiteTurn = !Board.isWhiteTurn;
-            bool ok = canCastle(Board, i);   // check
-            Board.isWhiteTurn = !Board.isWhiteTurn;
+    INSTRUMENT_ADD(ILLEGAL_REJECTED, pseudoLegal.size() - legal.size());
+}
 
-            if (!ok) continue; // always restore turn before continuing
-        }
+void MoveGenerator::generateLegalMoves(const CompactBoard& Board, std::vector<Move>& legal) {
+    INSTRUMENT_SCOPE(TIME_LEGAL_MOVES);
+    INSTRUMENT_COUNT(LEGAL_GENERATIONS);
 
-        // --- Make move ---
-        Unmove u = Board.makeMove(i);
+    pseudoLegalMoves(Board, pseudoLegal);
+    legal.clear();
+    legal.reserve(pseudoLegal.size());
+
+    // nothing to undo: the position after each move is a copy
+    for (const Move& m : pseudoLegal) {
+        if (m.wasCastling && !castlingPathSafe(Board, m, !Board.isWhiteTurn)) continue;
+        CompactBoard next = Board.play(m);
+        int king = findKing(next, Board.isWhiteTurn);
+        if (!isSquareAttacked(next, king, next.isWhiteTurn)) legal.push_back(m);
+    }
+
+    INSTRUMENT_ADD(ILLEGAL_REJECTED, pseudoLegal.size() - legal.size());
+}
+
+bool MoveGenerator::isLegal(board& Board, const Move& move) {
+    // --- Castling legality check ---
+    if (move.wasCastling) {
+        Board.isWhiteTurn = !Board.isWhiteTurn;
+        bool ok = canCastle(Board, move);   // check
+        Board.isWhiteTurn = !Board.isWhiteTurn;
+
+        if (!ok) return false; // always restore turn before returning
+    }
+
+    // --- Make move, test for check, undo (correct order!) ---
+    Unmove u = Board.makeMove(move);
+    bool legal = !canCaptureKing(Board);
+    Board.unmakeMove(move, u);
+    return legal;
+}
+
+void MoveGenerator::generatePieceMoves(board& Board, int sq, std::vector<Move>& moves) {
+    Piece piece = Board.currentState[sq];
+    if (piece == EMPTY || isWhitePiece(piece) != Board.isWhiteTurn) return;
+
+    switch (piece) {
+    case WN: case BN:
+        generateKnightMoves(Board, sq, piece, moves);
+        break;
+    case WP: case BP:
+        generatePawnMoves(Board, sq, piece, moves);
+        break;
+    case WK: case BK:
+        generateKingMoves(Board, sq, piece, moves);
+        generateCastlingMoves(Board, sq, piece, moves);
+        break;
+    default:
+        generateSlidingMoves(Board, sq, piece, moves);
+        break;
+    }
+}
+
+std::vector<Move> MoveGenerator::generateLegalCaptures(board& Board) {
+    std::vector<Move> legal;
+    generateLegalCaptures(Board, legal);
+    return legal;
+}
+
+void MoveGenerator::generateLegalCaptures(board& Board, std::vector<Move>& legal) {
+    pseudoLegalCaptures(Board, pseudoLegal);
+    legal.clear();
 
-        // --- Test for check ---
+    for (auto& i : pseudoLegal) {
+        // castling is never a capture, so only the king-safety test remains
+        Unmove u = Board.makeMove(i);
         if (!canCaptureKing(Board)) {
             legal.push_back(i);
         }
-
-        // --- Undo move (correct order!) ---
         Board.unmakeMove(i, u);
     }
+}
 
-    return legal;
+// Castling rights left after moved goes from -> to and takes captured: the
+// same masks the piece generators above apply move by move.
+static int rightsAfter(int rights, Piece moved, int from, Piece captured, int to) {
+    if (moved == WK) rights &= 0b1100;
+    else if (moved == BK) rights &= 0b0011;
+    else if (moved == WR && from == 63) rights &= 0b1110;
+    else if (moved == WR && from == 56) rights &= 0b1101;
+    else if (moved == BR && from == 0) rights &= 0b0111;
+    else if (moved == BR && from == 7) rights &= 0b1011;
+
+    if (captured == WR && to == 63) rights &= 0b1110;
+    else if (captured == WR && to == 56) rights &= 0b1101;
+    else if (captured == BR && to == 0) rights &= 0b0111;
+    else if (captured == BR && to == 7) rights &= 0b1011;
+    return rights;
+}
+
+// The captures and promotions of pseudoLegalMoves, in the same order,
+// without generating the quiet moves.
+void MoveGenerator::pseudoLegalCaptures(const board& Board, std::vector<Move>& moves) {
+    INSTRUMENT_SCOPE(TIME_PSEUDO_LEGAL_MOVES);
+    moves.clear();
+
+    bool white = Board.isWhiteTurn;
+    auto isEnemy = [&](Piece p) { return white ? isBlackPiece(p) : isWhitePiece(p); };
+    auto addCapture = [&](int from, int to, Piece moved) {
+        Piece target = Board.currentState[to];
+        moves.emplace_back(from, to, moved, target, rightsAfter(Board.castleRights, moved, from, target, to));
+    };
+
+    for (int i = 0; i < 64; ++i) {
+        Piece piece = Board.currentState[i];
+        if (piece == EMPTY || isWhitePiece(piece) != white) continue;
+        int row = i / 8, col = i % 8;
+
+        switch (piece) {
+        case WN: case BN:
+        case WK: case BK: {
+            bool knight = piece == WN || piece == BN;
+            const int (*deltas)[2] = knight ? KNIGHT_DELTAS : KING_DIRS;
+            for (int d = 0; d < 8; ++d) {
+                int r = row + deltas[d][0], c = col + deltas[d][1];
+                if (r < 0 || r >= 8 || c < 0 || c >= 8) continue;
+                if (isEnemy(Board.currentState[toIndex(r, c)])) addCapture(i, toIndex(r, c), piece);
+            }
+            break;
+        }
+        case WP: case BP: {
+            int forward = white ? -1 : 1;
+            int promoRank = white ? 1 : 6;
+            const Piece* promo = white ? WHITE_PROMOS : BLACK_PROMOS;
+
+            if (row == promoRank && Board.currentState[toIndex(row + forward, col)] == EMPTY) {
+                for (int k = 0; k < 4; ++k) {
+                    moves.emplace_back(i, toIndex(row + forward, col), piece, (Piece)EMPTY, Board.castleRights);
+                    moves.back().wasPromotion = true;
+                    moves.back().promotedTo = promo[k];
+                }
+            }
+            for (int cc : { col - 1, col + 1 }) {
+                if (cc < 0 || cc > 7) continue;
+                int to = toIndex(row + forward, cc);
+                if (!isEnemy(Board.currentState[to])) continue;
+                if (row == promoRank) {
+                    for (int k = 0; k < 4; ++k) {
+                        addCapture(i, to, piece);
+                        moves.back().wasPromotion = true;
+                        moves.back().promotedTo = promo[k];
+                    }
+                }
+                else {
+                    addCapture(i, to, piece);
+                }
+            }
+            if (row != promoRank && Board.hasEnPassant) {
+                for (int cc : { col - 1, col + 1 }) {
+                    if (cc < 0 || cc > 7 || toIndex(row + forward, cc) != Board.enPassantSquare) continue;
+                    moves.emplace_back(i, Board.enPassantSquare, piece, white ? BP : WP, Board.castleRights);
+                    moves.back().wasEnPassant = true;
+                }
+            }
+            break;
+        }
+        default: {
+            const int (*dirs)[2] = (piece == WR || piece == BR) ? ROOK_DIRS
+                : (piece == WB || piece == BB) ? BISHOP_DIRS : QUEEN_DIRS;
+            int dirCount = (piece == WQ || piece == BQ) ? 8 : 4;
+            for (int d = 0; d < dirCount; ++d) {
+                int r = row + dirs[d][0], c = col + dirs[d][1];
+                while (r >= 0 && r < 8 && c >= 0 && c < 8 && Board.currentState[toIndex(r, c)] == EMPTY) {
+                    r += dirs[d][0];
+                    c += dirs[d][1];
+                }
+                if (r >= 0 && r < 8 && c >= 0 && c < 8 && isEnemy(Board.currentState[toIndex(r, c)])) {
+                    addCapture(i, toIndex(r, c), piece);
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    INSTRUMENT_ADD(PSEUDO_LEGAL_MOVES, moves.size());
+}
+
+void MoveGenerator::generateUnmoves(board& Board, std::vector<Move>& unmoves) {
+    unmoves.clear();
+
+    // the side that made the last move, and the side it left to move
+    bool moverWhite = !Board.isWhiteTurn;
+    int opponentKing = findKing(Board, Board.isWhiteTurn);
+
+    for (int sq = 0; sq < 64; ++sq) {
+        Piece p = Board.currentState[sq];
+        if (p == EMPTY || isWhitePiece(p) != moverWhite) continue;
+
+        int row = sq / 8, col = sq % 8;
+        std::vector<int> origins;
+
+        auto stepOrigins = [&](const int (*deltas)[2], int count) {
+            for (int d = 0; d < count; ++d) {
+                int r = row + deltas[d][0], c = col + deltas[d][1];
+                if (r < 0 || r >= 8 || c < 0 || c >= 8) continue;
+                if (Board.currentState[toIndex(r, c)] == EMPTY) origins.push_back(toIndex(r, c));
+            }
+        };
+        auto rayOrigins = [&](const int (*dirs)[2], int count) {
+            for (int d = 0; d < count; ++d) {
+                for (int r = row + dirs[d][0], c = col + dirs[d][1];
+                    r >= 0 && r < 8 && c >= 0 && c < 8; r += dirs[d][0], c += dirs[d][1]) {
+                    if (Board.currentState[toIndex(r, c)] != EMPTY) break;
+                    origins.push_back(toIndex(r, c));
+                }
+            }
+        };
+
+        switch (p) {
+        case WK: case BK: stepOrigins(KING_DIRS, 8); break;
+        case WN: case BN: stepOrigins(KNIGHT_DELTAS, 8); break;
+        case WB: case BB: rayOrigins(BISHOP_DIRS, 4); break;
+        case WR: case BR: rayOrigins(ROOK_DIRS, 4); break;
+        case WQ: case BQ: rayOrigins(QUEEN_DIRS, 8); break;
+        case WP: case BP: {
+            // pawns step back towards their own side, never onto the first
+            // rank; from the fourth rank they may have come two squares
+            int back = (p == WP) ? 1 : -1;
+            int startRow = (p == WP) ? 6 : 1;
+            int prev = row + back;
+            if (prev < 1 || prev > 6 || row == startRow) break;
+            if (Board.currentState[toIndex(prev, col)] != EMPTY) break;
+            origins.push_back(toIndex(prev, col));
+            if (prev + back == startRow && Board.currentState[toIndex(startRow, col)] == EMPTY) {
+                origins.push_back(toIndex(startRow, col));
+            }
+            break;
+        }
+        default: break;
+        }
+
+        for (int from : origins) {
+            // in the earlier position the side now to move must not have
+            // been left in check
+            Board.currentState[from] = p;
+            Board.currentState[sq] = EMPTY;
+            bool legal = !isSquareAttacked(Board, opponentKing, moverWhite);
+            Board.currentState[sq] = p;
+            Board.currentState[from] = EMPTY;
+
+            if (legal) unmoves.push_back(Move(from, sq, p, EMPTY, Board.castleRights));
+        }
+    }
 }
 
 
 
 int MoveGenerator::findKing(const board& Board, bool white) {
+    return kingSquare(Board, white);
+}
+
+int MoveGenerator::findKing(const CompactBoard& Board, bool white) {
+    return kingSquare(Board, white);
+}
+
+bool MoveGenerator::isSquareAttacked(const board& Board, int sq, bool byWhite) {
+    return squareAttacked(Board, sq, byWhite);
+}
+
+bool MoveGenerator::isSquareAttacked(const CompactBoard& Board, int sq, bool byWhite) {
+    return squareAttacked(Board, sq, byWhite);
+}
+
+template <class Position>
+int MoveGenerator::kingSquare(const Position& Board, bool white) {
     Piece king = white ? WK : BK;
     for (int i = 0; i < 64; ++i) {
         if (Board.currentState[i] == king) return i;
@@ -710,7 +1005,9 @@ int MoveGenerator::findKing(const board& Board, bool white) {
     return -1; // should never happen
 }
 
-bool MoveGenerator::isSquareAttacked(const board& Board, int sq, bool byWhite) {
+template <class Position>
+bool MoveGenerator::squareAttacked(const Position& Board, int sq, bool byWhite) {
+    INSTRUMENT_COUNT(SQUARE_ATTACKED_CALLS);
     int row = sq / 8;
     int col = sq % 8;
 
@@ -798,3 +1095,140 @@ bool MoveGenerator::isSquareAttacked(const board& Board, int sq, bool byWhite) {
 
     return false;
 }
+
+
+uint64_t MoveGenerator::attackersTo(const board& Board, int sq, uint64_t occupied) {
+    uint64_t attackers = 0;
+    int row = sq / 8;
+    int col = sq % 8;
+
+    auto pieceAt = [&](int index) -> Piece {
+        return ((occupied >> index) & 1) ? Board.currentState[index] : EMPTY;
+    };
+
+    // --- Pawns: white pawns attack from the row below, black from above ---
+    if (row + 1 < 8) {
+        if (col > 0 && pieceAt((row + 1) * 8 + col - 1) == WP) attackers |= 1ULL << ((row + 1) * 8 + col - 1);
+        if (col < 7 && pieceAt((row + 1) * 8 + col + 1) == WP) attackers |= 1ULL << ((row + 1) * 8 + col + 1);
+    }
+    if (row - 1 >= 0) {
+        if (col > 0 && pieceAt((row - 1) * 8 + col - 1) == BP) attackers |= 1ULL << ((row - 1) * 8 + col - 1);
+        if (col < 7 && pieceAt((row - 1) * 8 + col + 1) == BP) attackers |= 1ULL << ((row - 1) * 8 + col + 1);
+    }
+
+    // --- Knights and kings ---
+    for (int d = 0; d < 8; ++d) {
+        int nr = row + KNIGHT_DELTAS[d][0];
+        int nc = col + KNIGHT_DELTAS[d][1];
+        if (nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            Piece p = pieceAt(nr * 8 + nc);
+            if (p == WN || p == BN) attackers |= 1ULL << (nr * 8 + nc);
+        }
+
+        nr = row + KING_DIRS[d][0];
+        nc = col + KING_DIRS[d][1];
+        if (nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            Piece p = pieceAt(nr * 8 + nc);
+            if (p == WK || p == BK) attackers |= 1ULL << (nr * 8 + nc);
+        }
+    }
+
+    // --- Sliders: first occupied square in each direction ---
+    for (int d = 0; d < 8; ++d) {
+        bool diagonal = (d >= 4);   // QUEEN_DIRS: 4 orthogonal, then 4 diagonal
+        int nr = row + QUEEN_DIRS[d][0];
+        int nc = col + QUEEN_DIRS[d][1];
+
+        while (nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            Piece p = pieceAt(nr * 8 + nc);
+            if (p != EMPTY) {
+                bool hits = diagonal
+                    ? (p == WB || p == BB || p == WQ || p == BQ)
+                    : (p == WR || p == BR || p == WQ || p == BQ);
+                if (hits) attackers |= 1ULL << (nr * 8 + nc);
+                break;
+            }
+            nr += QUEEN_DIRS[d][0];
+            nc += QUEEN_DIRS[d][1];
+        }
+    }
+
+    return attackers;
+}
+
+int MoveGenerator::staticExchange(const board& Board, const Move& move) {
+    INSTRUMENT_SCOPE(TIME_STATIC_EXCHANGE);
+    // EMPTY, BQ, BR, BP, BN, BK, BB, WQ, WR, WP, WN, WK, WB
+    static constexpr int SEE_VALUE[13] = {
+        0,
+        900, 500, 100, 300, 20000, 300,
+        900, 500, 100, 300, 20000, 300
+    };
+    // least valuable first
+    static constexpr Piece WHITE_ORDER[6] = { WP, WN, WB, WR, WQ, WK };
+    static constexpr Piece BLACK_ORDER[6] = { BP, BN, BB, BR, BQ, BK };
+
+    int gain[32];
+    int d = 0;
+    int to = move.to;
+
+    uint64_t occupied = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (Board.currentState[i] != EMPTY) occupied |= 1ULL << i;
+    }
+
+    gain[0] = SEE_VALUE[move.captured];
+    Piece onTarget = move.moved;
+    if (move.wasPromotion) {
+        gain[0] += SEE_VALUE[move.promotedTo] - SEE_VALUE[move.moved];
+        onTarget = move.promotedTo;
+    }
+    if (move.wasEnPassant) {
+        occupied &= ~(1ULL << (move.moved == WP ? to + 8 : to - 8));
+    }
+
+    uint64_t fromSet = 1ULL << move.from;
+    bool whiteToCapture = !isWhitePiece(move.moved);
+
+    do {
+        d++;
+        // speculative: the piece now on `to` is captured back
+        gain[d] = SEE_VALUE[onTarget] - gain[d - 1];
+
+        occupied &= ~fromSet;
+
+        // x-rays: recompute so sliders behind removed pieces join in
+        uint64_t attackers = attackersTo(Board, to, occupied) & occupied;
+
+        const Piece* order = whiteToCapture ? WHITE_ORDER : BLACK_ORDER;
+        fromSet = 0;
+        for (int k = 0; k < 6 && !fromSet; ++k) {
+            for (uint64_t a = attackers; a; a &= a - 1) {
+                int sq = lsbIndex(a);
+                if (Board.currentState[sq] == order[k]) {
+                    fromSet = 1ULL << sq;
+                    onTarget = order[k];
+                    break;
+                }
+            }
+        }
+
+        whiteToCapture = !whiteToCapture;
+    } while (fromSet && d < 31);
+
+    while (--d) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+
+    return gain[0];
+}
+
+// ---- Instantiations ----
+
+// The piece generators are public and used on a board outside this file;
+// a CompactBoard only reaches them through the overloads above.
+template void MoveGenerator::generateKnightMoves<board>(board&, int, Piece, std::vector<Move>&);
+template void MoveGenerator::generateSlidingMoves<board>(board&, int, Piece, std::vector<Move>&);
+template void MoveGenerator::generateKingMoves<board>(board&, int, Piece, std::vector<Move>&);
+template void MoveGenerator::generateCastlingMoves<board>(board&, int, Piece, std::vector<Move>&);
+template void MoveGenerator::generatePawnMoves<board>(board&, int, Piece, std::vector<Move>&);
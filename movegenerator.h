@@ -1,26 +1,69 @@
 #ifndef MOVEGENERATOR_H
 #define MOVEGENERATOR_H
 
+#include <cstdint>
+#include <vector>
+
 #include "board.h"
 
+class CompactBoard;
+
 class MoveGenerator
 {
 public:
     MoveGenerator();
     std::vector<Move> generatePseudoLegalMoves(board& Board);
     std::vector<Move> generateLegalMoves(board& Board);
+    std::vector<Move> generateLegalCaptures(board& Board);    // captures and promotions only
+
+    // Retractions: the quiet moves by the side not to move that could have
+    // led to Board, as forward moves (from = square before the move). Each
+    // earlier position is legal, i.e. the side now to move wasn't in check.
+    // Captures and promotions change the material and are left out, as are
+    // castling and en passant. Board is left unchanged.
+    void generateUnmoves(board& Board, std::vector<Move>& unmoves);
+
+    // Same as above but fill a caller-owned vector, so a caller that keeps
+    // it between positions doesn't allocate.
+    void generatePseudoLegalMoves(board& Board, std::vector<Move>& moves);
+    void generateLegalMoves(board& Board, std::vector<Move>& legal);
+    void generateLegalCaptures(board& Board, std::vector<Move>& legal);
 
+    // The same moves for a CompactBoard. Legality is tested on the copy
+    // CompactBoard::play returns, so Board is never modified.
+    void generatePseudoLegalMoves(const CompactBoard& Board, std::vector<Move>& moves);
+    void generateLegalMoves(const CompactBoard& Board, std::vector<Move>& legal);
 
-    void generateKnightMoves(board& Board, int i, Piece knightType, std::vector<Move>& moves);
-    void generateSlidingMoves(board& Board, int i, Piece piece, std::vector<Move>& moves);
-    void generateKingMoves(board& Board, int i, Piece kingType, std::vector<Move>& moves);
-    void generateCastlingMoves(board& Board, int i, Piece kingType, std::vector<Move>& moves);
-    void generatePawnMoves(board& Board, int i, Piece pawnType, std::vector<Move>& moves);
+
+    // Pseudo-legal moves of the piece on sq (castling included for a king)
+    // appended to moves, and the legality test generateLegalMoves applies
+    // to each of them. Together they check a single move without generating
+    // the whole position.
+    void generatePieceMoves(board& Board, int sq, std::vector<Move>& moves);
+    bool isLegal(board& Board, const Move& move);
+
+    // Position is board (instantiated for callers) or const CompactBoard.
+    template <class Position> void generateKnightMoves(Position& Board, int i, Piece knightType, std::vector<Move>& moves);
+    template <class Position> void generateSlidingMoves(Position& Board, int i, Piece piece, std::vector<Move>& moves);
+    template <class Position> void generateKingMoves(Position& Board, int i, Piece kingType, std::vector<Move>& moves);
+    template <class Position> void generateCastlingMoves(Position& Board, int i, Piece kingType, std::vector<Move>& moves);
+    template <class Position> void generatePawnMoves(Position& Board, int i, Piece pawnType, std::vector<Move>& moves);
 
     bool canCaptureKing(board& Board);
     bool canCastle(board& Board, const Move& move);
     bool isSquareAttacked(const board& Board, int sq, bool byWhite);
+    bool isSquareAttacked(const CompactBoard& Board, int sq, bool byWhite);
     int findKing(const board& Board, bool white);
+    int findKing(const CompactBoard& Board, bool white);
+
+    // Static exchange evaluation: material balance in centipawns of the
+    // capture sequence on move.to, both sides always recapturing with their
+    // least valuable attacker. Includes x-ray attackers behind the pieces
+    // that have already captured.
+    int staticExchange(const board& Board, const Move& move);
+    // Squares (bit i = square i) of pieces of both colours attacking sq,
+    // treating squares not set in occupied as empty.
+    uint64_t attackersTo(const board& Board, int sq, uint64_t occupied);
     
     inline int toIndex(int row, int col) const { return (row << 3) | col; }
     inline bool isWhitePiece(Piece p) {
@@ -31,6 +74,14 @@ public:
         return p >= BQ && p <= BB;
     }
 
+private:
+    template <class Position> void pseudoLegalMoves(Position& Board, std::vector<Move>& moves);
+    void pseudoLegalCaptures(const board& Board, std::vector<Move>& moves);
+    template <class Position> bool castlingPathSafe(const Position& Board, const Move& move, bool enemyWhite);
+    template <class Position> bool squareAttacked(const Position& Board, int sq, bool byWhite);
+    template <class Position> int kingSquare(const Position& Board, bool white);
+
+    std::vector<Move> pseudoLegal;  // scratch for generateLegalMoves and generateLegalCaptures
 };
 
 #endif
@@ -0,0 +1,124 @@
+#include "moveorder.h"
+#include "transpositiontable.h"
+#include "movegenerator.h"
+
+#include <cstring>
+
+// Victim/attacker values by Piece, EMPTY first. The king never is a victim
+// of a legal move but keeps the table dense.
+static constexpr int ORDER_VALUE[13] = {
+    0,
+    9, 5, 1, 3, 20, 3,
+    9, 5, 1, 3, 20, 3
+};
+
+static constexpr int SCORE_HASH      = 1000000;
+static constexpr int SCORE_CAPTURE   =  200000;
+static constexpr int SCORE_KILLER_1  =  190000;
+static constexpr int SCORE_KILLER_2  =  180000;
+static constexpr int SCORE_COUNTER   =  170000;
+static constexpr int SCORE_LOSING_CAPTURE = -50000;
+static constexpr int SCORE_UNDERPROMO = -100000;
+
+MoveOrderer::MoveOrderer() {
+    clear();
+}
+
+void MoveOrderer::clear() {
+    std::memset(killers, 0, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+    std::memset(counterMoves, 0, sizeof(counterMoves));
+}
+
+int MoveOrderer::mvvLva(const Move& m) {
+    // most valuable victim first, then least valuable attacker
+    return ORDER_VALUE[m.captured] * 32 - ORDER_VALUE[m.moved];
+}
+
+void MoveOrderer::scoreMoves(const board& Board, MoveGenerator& generator, const std::vector<Move>& moves,
+    std::vector<int>& scores, uint16_t ttMove, int ply, const Move* prevMove) const
+{
+    scores.resize(moves.size());
+
+    uint16_t killer1 = 0, killer2 = 0, counter = 0;
+    if (ply < MAX_PLY) {
+        killer1 = killers[ply][0];
+        killer2 = killers[ply][1];
+    }
+    if (prevMove) {
+        counter = counterMoves[prevMove->moved][prevMove->to];
+    }
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const Move& m = moves[i];
+        uint16_t packed = TranspositionTable::packMove(m);
+
+        if (ttMove && packed == ttMove) {
+            scores[i] = SCORE_HASH;
+        }
+        else if (m.wasPromotion) {
+            bool queen = (m.promotedTo == WQ || m.promotedTo == BQ);
+            scores[i] = queen ? SCORE_CAPTURE + ORDER_VALUE[m.captured] * 32 + 300
+                : SCORE_UNDERPROMO + ORDER_VALUE[m.promotedTo];
+        }
+        else if (m.captured != EMPTY) {
+            // a capture of an equal or bigger piece can never lose material
+            bool losing = ORDER_VALUE[m.captured] < ORDER_VALUE[m.moved]
+                && generator.staticExchange(Board, m) < 0;
+            scores[i] = (losing ? SCORE_LOSING_CAPTURE : SCORE_CAPTURE) + mvvLva(m);
+        }
+        else if (packed == killer1) {
+            scores[i] = SCORE_KILLER_1;
+        }
+        else if (packed == killer2) {
+            scores[i] = SCORE_KILLER_2;
+        }
+        else if (packed == counter) {
+            scores[i] = SCORE_COUNTER;
+        }
+        else {
+            scores[i] = history[m.moved >= WQ][m.from][m.to];
+        }
+    }
+}
+
+void MoveOrderer::pickNext(std::vector<Move>& moves, std::vector<int>& scores, size_t i) {
+    size_t best = i;
+    for (size_t j = i + 1; j < moves.size(); ++j) {
+        if (scores[j] > scores[best]) best = j;
+    }
+    if (best != i) {
+        std::swap(moves[i], moves[best]);
+        std::swap(scores[i], scores[best]);
+    }
+}
+
+void MoveOrderer::updateHistory(const Move& m, int bonus) {
+    // gravity keeps every entry inside [-MAX_HISTORY, MAX_HISTORY]
+    int& h = history[m.moved >= WQ][m.from][m.to];
+    int absBonus = bonus < 0 ? -bonus : bonus;
+    h += bonus - h * absBonus / MAX_HISTORY;
+}
+
+void MoveOrderer::updateQuiet(const Move& best, int depth, int ply, const Move* prevMove,
+    const std::vector<Move>& quietsTried)
+{
+    uint16_t packed = TranspositionTable::packMove(best);
+
+    if (ply < MAX_PLY && killers[ply][0] != packed) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = packed;
+    }
+
+    if (prevMove) {
+        counterMoves[prevMove->moved][prevMove->to] = packed;
+    }
+
+    int bonus = depth * depth;
+    if (bonus > 400) bonus = 400;
+
+    updateHistory(best, bonus);
+    for (const Move& m : quietsTried) {
+        updateHistory(m, -bonus);
+    }
+}
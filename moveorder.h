@@ -0,0 +1,55 @@
+#ifndef MOVEORDER_H
+#define MOVEORDER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+class MoveGenerator;
+
+// Move ordering for alpha-beta. Scores each move of a node so the search
+// can pick the most promising one first:
+//
+//   hash move > winning/equal captures by MVV-LVA and queen promotions
+//             > killer 1 > killer 2 > counter-move > quiets by history
+//             > losing captures by MVV-LVA > under-promotions
+//
+// A capture loses when the static exchange on its square is negative.
+//
+// Killers, history and counter-moves are learned from beta cutoffs, so one
+// MoveOrderer belongs to exactly one search thread.
+class MoveOrderer
+{
+public:
+    static constexpr int MAX_PLY = 64;
+    static constexpr int MAX_HISTORY = 16384;
+
+    MoveOrderer();
+    void clear();
+
+    // Board is the position the moves are generated from; generator is only
+    // used for the static exchange of captures.
+    void scoreMoves(const board& Board, MoveGenerator& generator, const std::vector<Move>& moves,
+        std::vector<int>& scores, uint16_t ttMove, int ply, const Move* prevMove) const;
+
+    // Selection sort step: swaps the best remaining move into slot i.
+    static void pickNext(std::vector<Move>& moves, std::vector<int>& scores, size_t i);
+
+    // Called on a beta cutoff by quiet move `best`; `quietsTried` are the
+    // quiet moves searched before it at this node and get a history malus.
+    void updateQuiet(const Move& best, int depth, int ply, const Move* prevMove,
+        const std::vector<Move>& quietsTried);
+
+    static bool isQuiet(const Move& m) { return m.captured == EMPTY && !m.wasPromotion; }
+    static int mvvLva(const Move& m);
+
+private:
+    void updateHistory(const Move& m, int bonus);
+
+    uint16_t killers[MAX_PLY][2];
+    int history[2][64][64];         // butterfly table: [white][from][to]
+    uint16_t counterMoves[13][64];  // reply to [previous moved piece][previous to]
+};
+
+#endif // MOVEORDER_H
@@ -0,0 +1,266 @@
+#include "nnue.h"
+#include "mappedfile.h"
+
+#include <cstring>
+#include <memory>
+
+// The AVX2 kernels are built into every x86 binary. Without -mavx2 they
+// are compiled for that target alone and picked at run time if the CPU has
+// AVX2; with it they are always used.
+#if defined(__AVX2__)
+#define NNUE_AVX2 1
+#define NNUE_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NNUE_AVX2 1
+#define NNUE_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef NNUE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Nnue {
+
+static_assert(HIDDEN % 32 == 0, "kernels work on 32 hidden units at a time");
+
+struct Network {
+    const int16_t* featureBias;
+    const int16_t* featureWeights;  // [INPUTS][HIDDEN]
+    const int8_t* outputWeights;    // [2 * HIDDEN], side to move first
+    int32_t outputBias;
+};
+
+static std::unique_ptr<MappedFile> file;
+static Network net;
+bool detail::loaded = false;
+using detail::loaded;
+
+static constexpr size_t FEATURE_BIAS_BYTES = HIDDEN * sizeof(int16_t);
+static constexpr size_t FEATURE_WEIGHT_BYTES = (size_t)INPUTS * HIDDEN * sizeof(int16_t);
+static constexpr size_t OUTPUT_WEIGHT_BYTES = 2 * HIDDEN * sizeof(int8_t);
+static constexpr size_t FILE_SIZE = HEADER_SIZE + FEATURE_BIAS_BYTES + FEATURE_WEIGHT_BYTES
+    + OUTPUT_WEIGHT_BYTES + sizeof(int32_t);
+
+bool load(const std::string& path) {
+    std::unique_ptr<MappedFile> candidate(new MappedFile());
+    if (!candidate->open(path) || candidate->size() != FILE_SIZE) return false;
+
+    const uint8_t* p = candidate->data();
+    uint32_t hidden;
+    std::memcpy(&hidden, p + 8, sizeof(hidden));
+    if (std::memcmp(p, "CMGNNUE1", 8) != 0 || hidden != HIDDEN) return false;
+
+    p += HEADER_SIZE;
+    net.featureBias = (const int16_t*)p;
+    p += FEATURE_BIAS_BYTES;
+    net.featureWeights = (const int16_t*)p;
+    p += FEATURE_WEIGHT_BYTES;
+    net.outputWeights = (const int8_t*)p;
+    p += OUTPUT_WEIGHT_BYTES;
+    std::memcpy(&net.outputBias, p, sizeof(int32_t));
+
+    // the old mapping goes only once the new one is in use
+    file = std::move(candidate);
+    loaded = true;
+    return true;
+}
+
+void unload() {
+    loaded = false;
+    file.reset();
+}
+
+static bool cpuHasAvx2() {
+#if defined(__AVX2__)
+    return true;
+#elif defined(NNUE_AVX2)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+static bool useAvx2 = cpuHasAvx2();
+
+const char* kernelName() {
+    return useAvx2 ? "avx2" : "scalar";
+}
+
+bool selectKernel(const std::string& name) {
+    if (name == "scalar") useAvx2 = false;
+    else if (name == "avx2" && cpuHasAvx2()) useAvx2 = true;
+    else return false;
+    return true;
+}
+
+// Feature of piece on sq seen from perspective (1 = white, 0 = black): own
+// pieces first, board flipped vertically for black. Piece order is
+// EMPTY, BQ, BR, BP, BN, BK, BB, WQ, WR, WP, WN, WK, WB.
+static inline int featureIndex(int perspective, int piece, int sq) {
+    bool white = piece >= 7;
+    int type = white ? piece - 7 : piece - 1;
+    int theirs = (white == (perspective == 1)) ? 0 : 1;
+    int square = perspective == 1 ? sq : (sq ^ 56);
+    return ((theirs * 6 + type) << 6) | square;
+}
+
+// ---- Accumulator kernels ----
+
+static inline void addRowScalar(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < HIDDEN; ++i) acc[i] += row[i];
+}
+
+static inline void subRowScalar(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < HIDDEN; ++i) acc[i] -= row[i];
+}
+
+// acc += add - sub in one pass, for a piece moving between squares
+static inline void addSubRowScalar(int16_t* acc, const int16_t* add, const int16_t* sub) {
+    for (int i = 0; i < HIDDEN; ++i) acc[i] += add[i] - sub[i];
+}
+
+#ifdef NNUE_AVX2
+NNUE_AVX2_TARGET static void addRowAvx2(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i*)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(row + i));
+        _mm256_store_si256((__m256i*)(acc + i), _mm256_add_epi16(a, w));
+    }
+}
+
+NNUE_AVX2_TARGET static void subRowAvx2(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i*)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(row + i));
+        _mm256_store_si256((__m256i*)(acc + i), _mm256_sub_epi16(a, w));
+    }
+}
+
+NNUE_AVX2_TARGET static void addSubRowAvx2(int16_t* acc, const int16_t* add, const int16_t* sub) {
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i*)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(add + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(sub + i));
+        _mm256_store_si256((__m256i*)(acc + i), _mm256_sub_epi16(_mm256_add_epi16(a, w), s));
+    }
+}
+#endif
+
+static inline void addRow(int16_t* acc, const int16_t* row) {
+#ifdef NNUE_AVX2
+    if (useAvx2) {
+        addRowAvx2(acc, row);
+        return;
+    }
+#endif
+    addRowScalar(acc, row);
+}
+
+static inline void subRow(int16_t* acc, const int16_t* row) {
+#ifdef NNUE_AVX2
+    if (useAvx2) {
+        subRowAvx2(acc, row);
+        return;
+    }
+#endif
+    subRowScalar(acc, row);
+}
+
+static inline void addSubRow(int16_t* acc, const int16_t* add, const int16_t* sub) {
+#ifdef NNUE_AVX2
+    if (useAvx2) {
+        addSubRowAvx2(acc, add, sub);
+        return;
+    }
+#endif
+    addSubRowScalar(acc, add, sub);
+}
+
+static inline const int16_t* weightRow(int perspective, int piece, int sq) {
+    return net.featureWeights + (size_t)featureIndex(perspective, piece, sq) * HIDDEN;
+}
+
+void clear(Accumulator& acc) {
+    for (int side = 0; side < 2; ++side) {
+        std::memcpy(acc.values[side], net.featureBias, FEATURE_BIAS_BYTES);
+    }
+}
+
+void addPiece(Accumulator& acc, int piece, int sq) {
+    if (piece == 0) return;
+    for (int side = 0; side < 2; ++side) {
+        addRow(acc.values[side], weightRow(side, piece, sq));
+    }
+}
+
+void removePiece(Accumulator& acc, int piece, int sq) {
+    if (piece == 0) return;
+    for (int side = 0; side < 2; ++side) {
+        subRow(acc.values[side], weightRow(side, piece, sq));
+    }
+}
+
+void movePiece(Accumulator& acc, int piece, int from, int to) {
+    if (piece == 0) return;
+    for (int side = 0; side < 2; ++side) {
+        addSubRow(acc.values[side], weightRow(side, piece, to), weightRow(side, piece, from));
+    }
+}
+
+// ---- Output layer ----
+
+// Sum of clamp(acc[i], 0, CLIP) * weights[i] over one half.
+static inline int32_t outputHalfScalar(const int16_t* acc, const int8_t* weights) {
+    int32_t sum = 0;
+    for (int i = 0; i < HIDDEN; ++i) {
+        int a = acc[i] < 0 ? 0 : (acc[i] > CLIP ? CLIP : acc[i]);
+        sum += a * weights[i];
+    }
+    return sum;
+}
+
+#ifdef NNUE_AVX2
+NNUE_AVX2_TARGET static int32_t outputHalfAvx2(const int16_t* acc, const int8_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i clip = _mm256_set1_epi16(CLIP);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int i = 0; i < HIDDEN; i += 32) {
+        __m256i a = _mm256_load_si256((const __m256i*)(acc + i));
+        __m256i b = _mm256_load_si256((const __m256i*)(acc + i + 16));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), clip);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), clip);
+
+        // packus interleaves 128-bit lanes; the permute puts units back in order
+        __m256i activations = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+
+        // u8 x i8 -> pairs of i16 (at most 2 * 127 * 128, no saturation) -> i32
+        __m256i products = _mm256_maddubs_epi16(activations, w);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+static inline int32_t outputHalf(const int16_t* acc, const int8_t* weights) {
+#ifdef NNUE_AVX2
+    if (useAvx2) return outputHalfAvx2(acc, weights);
+#endif
+    return outputHalfScalar(acc, weights);
+}
+
+int evaluate(const Accumulator& acc, bool whiteToMove) {
+    int us = whiteToMove ? 1 : 0;
+    int32_t sum = net.outputBias
+        + outputHalf(acc.values[us], net.outputWeights)
+        + outputHalf(acc.values[us ^ 1], net.outputWeights + HIDDEN);
+    return sum / (CLIP * OUTPUT_WEIGHT_SCALE);
+}
+
+} // namespace Nnue
@@ -0,0 +1,72 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <string>
+
+// Efficiently updatable neural network evaluation.
+//
+//   768 inputs (colour x piece type x square, from each side's point of view)
+//     -> HIDDEN int16 accumulator per side, kept up to date by board
+//     -> clipped ReLU to [0, CLIP], side to move's half first
+//     -> int8 output layer -> centipawns
+//
+// The float network the weights were quantised from computes
+//   cp = sum(a_i * w_i) + b  with activations a_i in [0, 1],
+// quantised as a_i * CLIP (int16 accumulator, int16 feature weights),
+// w_i * OUTPUT_WEIGHT_SCALE (int8) and b * CLIP * OUTPUT_WEIGHT_SCALE (int32).
+//
+// Weights file, little endian, every section starting at a multiple of 32:
+//   char[8]   "CMGNNUE1"
+//   uint32    HIDDEN
+//   byte[52]  zero padding up to HEADER_SIZE
+//   int16     feature bias[HIDDEN]
+//   int16     feature weights[768][HIDDEN]
+//   int8      output weights[2 * HIDDEN]
+//   int32     output bias
+// The file is memory-mapped and used in place.
+namespace Nnue {
+
+constexpr int INPUTS = 768;
+constexpr int HIDDEN = 256;
+constexpr int CLIP = 127;
+constexpr int OUTPUT_WEIGHT_SCALE = 64;
+constexpr int HEADER_SIZE = 64;
+
+// First-layer output for both points of view, [0] = black, [1] = white.
+struct alignas(32) Accumulator {
+    int16_t values[2][HIDDEN];
+};
+
+// Maps a weights file and makes it the active network. On failure the
+// previous network, if any, stays active and false is returned.
+bool load(const std::string& path);
+void unload();
+
+namespace detail {
+extern bool loaded;
+}
+
+// True while a network is loaded. Boards skip accumulator updates otherwise.
+inline bool active() { return detail::loaded; }
+
+// Sets acc to the empty board (biases only); add the pieces after it.
+void clear(Accumulator& acc);
+// Pieces use the board's Piece values; EMPTY is ignored.
+void addPiece(Accumulator& acc, int piece, int sq);
+void removePiece(Accumulator& acc, int piece, int sq);
+void movePiece(Accumulator& acc, int piece, int from, int to);
+
+// Centipawns from the side to move's point of view.
+int evaluate(const Accumulator& acc, bool whiteToMove);
+
+// "avx2" or "scalar": the kernels in use. AVX2 is chosen at startup when
+// the CPU supports it.
+const char* kernelName();
+// Switches kernels, e.g. to compare them. False if name is unknown or the
+// CPU can't run it.
+bool selectKernel(const std::string& name);
+
+} // namespace Nnue
+
+#endif // NNUE_H
@@ -0,0 +1,256 @@
+#include "notation.h"
+#include "bitops.h"
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+std::string squareName(int sq) {
+    std::string name;
+    name += (char)('a' + sq % 8);
+    name += (char)('8' - sq / 8);
+    return name;
+}
+
+int squareFromName(std::string_view name) {
+    if (name.size() < 2) return -1;
+    if (name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8') return -1;
+    return ('8' - name[1]) * 8 + (name[0] - 'a');
+}
+
+static char promotionLetter(Piece p) {
+    switch (p) {
+    case WQ: case BQ: return 'q';
+    case WR: case BR: return 'r';
+    case WB: case BB: return 'b';
+    case WN: case BN: return 'n';
+    default: return 0;
+    }
+}
+
+std::string moveToUci(const Move& m) {
+    if (m.from < 0 || m.to < 0) return "0000";
+
+    std::string text = squareName(m.from) + squareName(m.to);
+    if (m.wasPromotion) {
+        text += promotionLetter(m.promotedTo);
+    }
+    return text;
+}
+
+// The piece of the side to move standing on from that has a legal move
+// matching to and promo (0 = not a promotion).
+static bool findMove(board& Board, MoveGenerator& generator, int from, int to, char promo, Move& move) {
+    static thread_local std::vector<Move> moves;
+    moves.clear();
+    generator.generatePieceMoves(Board, from, moves);
+
+    for (const Move& m : moves) {
+        if (m.to != to) continue;
+        if ((m.wasPromotion ? promotionLetter(m.promotedTo) : 0) != promo) continue;
+        if (!generator.isLegal(Board, m)) continue;
+        move = m;
+        return true;
+    }
+    return false;
+}
+
+bool parseUciMove(board& Board, MoveGenerator& generator, std::string_view text, Move& move) {
+    if (text.size() < 4) return false;
+
+    int from = squareFromName(text.substr(0, 2));
+    int to = squareFromName(text.substr(2, 2));
+    if (from < 0 || to < 0) return false;
+    char promo = text.size() > 4 ? (char)tolower(text[4]) : 0;
+
+    return findMove(Board, generator, from, to, promo, move);
+}
+
+// ---- SAN ----
+
+static char pieceLetter(Piece p) {
+    switch (p) {
+    case WK: case BK: return 'K';
+    case WQ: case BQ: return 'Q';
+    case WR: case BR: return 'R';
+    case WB: case BB: return 'B';
+    case WN: case BN: return 'N';
+    default: return 0;
+    }
+}
+
+// Squares of pieces equal to piece that attack to: the piece's own
+// attack pattern traced back from the target square.
+static uint64_t rivals(const board& Board, Piece piece, int to) {
+    static const int STEPS[8][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1} };
+    static const int KNIGHT[8][2] = { {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1} };
+
+    int row = to / 8, col = to % 8;
+    uint64_t found = 0;
+    auto check = [&](int r, int c) {
+        if (r < 0 || r > 7 || c < 0 || c > 7) return false;
+        if (Board.currentState[r * 8 + c] == piece) found |= 1ULL << (r * 8 + c);
+        return Board.currentState[r * 8 + c] == EMPTY;
+    };
+
+    switch (piece) {
+    case WN: case BN:
+        for (const auto& d : KNIGHT) check(row + d[0], col + d[1]);
+        break;
+    case WK: case BK:
+        for (const auto& d : STEPS) check(row + d[0], col + d[1]);
+        break;
+    default: {
+        // rooks the first four directions, bishops the last four
+        int first = (piece == WB || piece == BB) ? 4 : 0;
+        int last = (piece == WR || piece == BR) ? 4 : 8;
+        for (int d = first; d < last; ++d) {
+            int r = row + STEPS[d][0], c = col + STEPS[d][1];
+            while (check(r, c)) {
+                r += STEPS[d][0];
+                c += STEPS[d][1];
+            }
+        }
+        break;
+    }
+    }
+    return found;
+}
+
+static bool hasLegalMove(board& Board, MoveGenerator& generator) {
+    static thread_local std::vector<Move> moves;
+    for (int sq = 0; sq < 64; ++sq) {
+        moves.clear();
+        generator.generatePieceMoves(Board, sq, moves);
+        for (const Move& m : moves) {
+            if (generator.isLegal(Board, m)) return true;
+        }
+    }
+    return false;
+}
+
+std::string moveToSan(board& Board, MoveGenerator& generator, const Move& m) {
+    std::string san;
+
+    if (m.wasCastling) {
+        san = (m.to % 8 == 6) ? "O-O" : "O-O-O";
+    }
+    else if (m.moved == WP || m.moved == BP) {
+        if (m.captured != EMPTY || m.wasEnPassant) {
+            san += (char)('a' + m.from % 8);
+            san += 'x';
+        }
+        san += squareName(m.to);
+        if (m.wasPromotion) {
+            san += '=';
+            san += pieceLetter(m.promotedTo);
+        }
+    }
+    else {
+        san += pieceLetter(m.moved);
+
+        // other pieces of the same kind that could also go to m.to
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        uint64_t others = m.moved == WK || m.moved == BK ? 0 : rivals(Board, m.moved, m.to);
+        others &= ~(1ULL << m.from);
+        for (; others; others &= others - 1) {
+            int sq = lsbIndex(others);
+            Move other;
+            if (!findMove(Board, generator, sq, m.to, 0, other)) continue;   // pinned
+            ambiguous = true;
+            if (sq % 8 == m.from % 8) sameFile = true;
+            if (sq / 8 == m.from / 8) sameRank = true;
+        }
+        if (ambiguous && (!sameFile || sameRank)) san += (char)('a' + m.from % 8);
+        if (ambiguous && sameFile) san += (char)('8' - m.from / 8);
+
+        if (m.captured != EMPTY) san += 'x';
+        san += squareName(m.to);
+    }
+
+    Unmove u = Board.makeMove(m);
+    int king = generator.findKing(Board, Board.isWhiteTurn);
+    if (generator.isSquareAttacked(Board, king, !Board.isWhiteTurn)) {
+        san += hasLegalMove(Board, generator) ? '+' : '#';
+    }
+    Board.unmakeMove(m, u);
+    return san;
+}
+
+bool parseSanMove(board& Board, MoveGenerator& generator, std::string_view text, Move& move) {
+    while (!text.empty() && std::strchr("+#!?", text.back())) text.remove_suffix(1);
+    if (text.empty()) return false;
+
+    // ---- Castling ----
+    if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0") {
+        int king = generator.findKing(Board, Board.isWhiteTurn);
+        int to = king + (text.size() == 3 ? 2 : -2);
+        if (king < 0 || !findMove(Board, generator, king, to, 0, move)) return false;
+        return move.wasCastling;
+    }
+
+    // ---- Promotion ----
+    char promo = 0;
+    if (text.size() > 2 && std::strchr("QRBN", text.back()) && text[0] >= 'a' && text[0] <= 'h') {
+        promo = (char)tolower(text.back());
+        text.remove_suffix(1);
+        if (text.back() == '=') text.remove_suffix(1);
+    }
+
+    // ---- Piece, target and disambiguation ----
+    char letter = 'P';
+    if (std::strchr("KQRBN", text[0])) {
+        letter = text[0];
+        text.remove_prefix(1);
+    }
+    if (text.size() < 2) return false;
+    int to = squareFromName(text.substr(text.size() - 2));
+    if (to < 0) return false;
+    text.remove_suffix(2);
+    if (!text.empty() && text.back() == 'x') text.remove_suffix(1);
+
+    int fromFile = -1, fromRank = -1;
+    for (char c : text) {
+        if (c >= 'a' && c <= 'h') fromFile = c - 'a';
+        else if (c >= '1' && c <= '8') fromRank = '8' - c;
+        else return false;
+    }
+
+    bool white = Board.isWhiteTurn;
+    uint64_t candidates = 0;
+    if (letter == 'P') {
+        int back = white ? 8 : -8;  // one row towards the pawn's own side
+        if (fromFile >= 0 && fromFile != to % 8) {
+            int from = to + back + (fromFile - to % 8);
+            if (from >= 0 && from < 64) candidates = 1ULL << from;
+        }
+        else if (to + back >= 0 && to + back < 64) {
+            int from = to + back;
+            if (Board.currentState[from] == EMPTY && to + 2 * back >= 0 && to + 2 * back < 64) from += back;
+            candidates = 1ULL << from;
+        }
+    }
+    else {
+        static const char* LETTERS = "QRBNKP";
+        static const Piece WHITE[] = { WQ, WR, WB, WN, WK, WP };
+        static const Piece BLACK[] = { BQ, BR, BB, BN, BK, BP };
+        int k = (int)(std::strchr(LETTERS, letter) - LETTERS);
+        candidates = rivals(Board, white ? WHITE[k] : BLACK[k], to);
+    }
+
+    bool found = false;
+    for (; candidates; candidates &= candidates - 1) {
+        int sq = lsbIndex(candidates);
+        if (fromFile >= 0 && sq % 8 != fromFile) continue;
+        if (fromRank >= 0 && sq / 8 != fromRank) continue;
+
+        Move m;
+        if (!findMove(Board, generator, sq, to, promo, m)) continue;
+        if (m.wasCastling) continue;    // "Kg1" is not castling
+        if (letter == 'P' && m.moved != WP && m.moved != BP) continue;
+        if (found) return false;        // ambiguous
+        move = m;
+        found = true;
+    }
+    return found;
+}
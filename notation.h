@@ -0,0 +1,32 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include <string>
+#include <string_view>
+
+#include "board.h"
+#include "movegenerator.h"
+
+// Square 0 is a8, 63 is h1.
+std::string squareName(int sq);
+// -1 if name is not a square like "e4".
+int squareFromName(std::string_view name);
+
+// Long algebraic notation as used by UCI: "e2e4", "e7e8q". "0000" for no move.
+std::string moveToUci(const Move& m);
+
+// Finds the legal move of Board written as text. Returns false if there is none.
+bool parseUciMove(board& Board, MoveGenerator& generator, std::string_view text, Move& move);
+
+// Standard algebraic notation of m, a legal move of Board: "Nbd7", "exd5",
+// "e8=Q+", "O-O-O#". Disambiguation comes from the attackers of the target
+// square, so only the moves of rival pieces are tested for legality.
+std::string moveToSan(board& Board, MoveGenerator& generator, const Move& m);
+
+// Parses SAN as written in PGN: check marks and annotations (+ # ! ?) are
+// ignored, "0-0" is accepted for "O-O" and the "=" before a promotion is
+// optional. Only pieces that attack the target square, or pawns that can
+// reach it, are tried. False if no legal move, or more than one, matches.
+bool parseSanMove(board& Board, MoveGenerator& generator, std::string_view text, Move& move);
+
+#endif // NOTATION_H
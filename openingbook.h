@@ -0,0 +1,52 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+#include "mappedfile.h"
+
+// Polyglot hash of a position. Differs from board::zobristKey: it uses the
+// fixed Random64 table of the format, and en passant only counts when a
+// pawn of the side to move stands next to the double-pushed pawn.
+uint64_t polyglotKey(const board& Board);
+
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+// Read-only Polyglot (.bin) opening book. The file is memory-mapped and
+// searched in place: entries are 16 bytes, big-endian, sorted by key.
+class OpeningBook
+{
+public:
+    OpeningBook();
+
+    // False if the file can't be mapped or isn't a whole number of entries.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return file.size() / ENTRY_SIZE; }
+
+    // Book moves for Board that are legal in it, in file order. Entries that
+    // don't decode to a legal move (a key collision, a broken book) are dropped.
+    std::vector<BookMove> lookup(board& Board, MoveGenerator& generator) const;
+
+    // Picks one of the book moves at random, each with probability
+    // proportional to its weight. False if Board is not in the book.
+    bool pickMove(board& Board, MoveGenerator& generator, Move& move);
+
+    static constexpr size_t ENTRY_SIZE = 16;
+
+private:
+    MappedFile file;
+    std::mt19937 rng;
+};
+
+#endif // OPENINGBOOK_H
@@ -0,0 +1,316 @@
+#include "perft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#else
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+long long perft(MoveGenerator& generator, board& Board, int depth) {
+    if (depth <= 0) return 1;
+
+    std::vector<Move> moves = generator.generateLegalMoves(Board);
+    if (depth == 1) return (long long)moves.size();
+
+    long long nodes = 0;
+    for (const Move& m : moves) {
+        Unmove u = Board.makeMove(m);
+        nodes += perft(generator, Board, depth - 1);
+        Board.unmakeMove(m, u);
+    }
+    return nodes;
+}
+
+std::vector<std::pair<Move, long long>> perftDivide(MoveGenerator& generator, board& Board, int depth) {
+    std::vector<std::pair<Move, long long>> result;
+    if (depth <= 0) return result;
+
+    for (const Move& m : generator.generateLegalMoves(Board)) {
+        Unmove u = Board.makeMove(m);
+        result.emplace_back(m, perft(generator, Board, depth - 1));
+        Board.unmakeMove(m, u);
+    }
+    return result;
+}
+
+// ---- Sharded perft ----
+
+void PerftCount::add(uint64_t nodes, uint64_t times) {
+    // 64 x 64 -> 128 bit product from 32-bit halves
+    uint64_t aLo = nodes & 0xFFFFFFFF, aHi = nodes >> 32;
+    uint64_t bLo = times & 0xFFFFFFFF, bHi = times >> 32;
+    uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    uint64_t productLow = (mid << 32) | (ll & 0xFFFFFFFF);
+    uint64_t productHigh = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+
+    low += productLow;
+    high += productHigh + (low < productLow ? 1 : 0);
+}
+
+std::string PerftCount::toString() const {
+    // long division by 10 over 32-bit limbs, most significant first
+    uint32_t limbs[4] = { (uint32_t)(high >> 32), (uint32_t)high, (uint32_t)(low >> 32), (uint32_t)low };
+    std::string digits;
+    do {
+        uint64_t rem = 0;
+        for (uint32_t& limb : limbs) {
+            uint64_t cur = (rem << 32) | limb;
+            limb = (uint32_t)(cur / 10);
+            rem = cur % 10;
+        }
+        digits += char('0' + rem);
+    } while (limbs[0] | limbs[1] | limbs[2] | limbs[3]);
+    return std::string(digits.rbegin(), digits.rend());
+}
+
+// FEN with the clocks zeroed: they don't change the count, and positions
+// that differ only in them share a job.
+static std::string jobFen(const board& Board) {
+    std::string fen = Board.toFEN();
+    size_t clocks = fen.rfind(' ', fen.rfind(' ') - 1);
+    return fen.substr(0, clocks) + " 0 1";
+}
+
+static void expandJobs(MoveGenerator& generator, board& Board, int ply, int splitDepth, int depth,
+    std::map<std::string, size_t>& index, std::vector<PerftJob>& jobs) {
+    if (ply == splitDepth) {
+        std::string fen = jobFen(Board);
+        auto it = index.find(fen);
+        if (it != index.end()) {
+            ++jobs[it->second].multiplicity;
+        }
+        else {
+            index[fen] = jobs.size();
+            jobs.push_back({ fen, depth - splitDepth, 1 });
+        }
+        return;
+    }
+
+    for (const Move& m : generator.generateLegalMoves(Board)) {
+        Unmove u = Board.makeMove(m);
+        expandJobs(generator, Board, ply + 1, splitDepth, depth, index, jobs);
+        Board.unmakeMove(m, u);
+    }
+}
+
+std::vector<PerftJob> perftJobs(MoveGenerator& generator, board& Board, int depth, int splitDepth) {
+    std::map<std::string, size_t> index;
+    std::vector<PerftJob> jobs;
+    expandJobs(generator, Board, 0, std::max(0, std::min(splitDepth, depth)), depth, index, jobs);
+    return jobs;
+}
+
+static std::string jobKey(const std::string& fen, int depth) {
+    return std::to_string(depth) + " " + fen;
+}
+
+// Checkpoint lines are "<depth> <nodes> <fen>". A line cut short by a crash
+// has no newline and is ignored.
+static void readCheckpoint(const std::string& path, std::map<std::string, uint64_t>& done) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (in.eof()) break;
+        std::istringstream fields(line);
+        int depth;
+        uint64_t nodes;
+        std::string fen;
+        if (fields >> depth >> nodes && std::getline(fields >> std::ws, fen)) {
+            done[jobKey(fen, depth)] = nodes;
+        }
+    }
+}
+
+static uint64_t runJob(MoveGenerator& generator, const PerftJob& job) {
+    board b;
+    b.loadFEN(job.fen);
+    return (uint64_t)perft(generator, b, job.depth);
+}
+
+// Runs the jobs listed in pending and calls finished(job index, nodes) on
+// the calling thread as each one completes. False if some didn't.
+template <typename Finished>
+static bool runWorkers(const std::vector<PerftJob>& jobs, const std::vector<uint32_t>& pending,
+    int workers, Finished finished) {
+#ifdef _WIN32
+    // no fork(): worker threads in this process instead
+    std::atomic<size_t> next{ 0 };
+    std::mutex resultMutex;
+    std::vector<std::pair<uint32_t, uint64_t>> results;
+    std::condition_variable resultReady;
+    std::atomic<int> running{ workers };
+
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            MoveGenerator generator;
+            for (size_t i; (i = next.fetch_add(1)) < pending.size(); ) {
+                uint64_t nodes = runJob(generator, jobs[pending[i]]);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                results.emplace_back(pending[i], nodes);
+                resultReady.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(resultMutex);
+            --running;
+            resultReady.notify_one();
+        });
+    }
+
+    size_t received = 0;
+    for (;;) {
+        std::vector<std::pair<uint32_t, uint64_t>> batch;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultReady.wait(lock, [&]() { return !results.empty() || running == 0; });
+            batch.swap(results);
+        }
+        for (const auto& r : batch) finished(r.first, r.second);
+        received += batch.size();
+        if (batch.empty()) break;
+    }
+    for (auto& t : pool) t.join();
+    return received == pending.size();
+#else
+    // Job indices go down one pipe, results come back up another. Each
+    // 4-byte read takes one whole job, so a free worker takes the next.
+    int jobPipe[2], resultPipe[2];
+    if (pipe(jobPipe) != 0) return false;
+    if (pipe(resultPipe) != 0) {
+        close(jobPipe[0]);
+        close(jobPipe[1]);
+        return false;
+    }
+    fflush(stdout);
+
+    // with every worker gone, writing a job would raise SIGPIPE and kill
+    // the process; ignored, the write fails and the run reports the failure
+    void (*previousSigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+
+    std::vector<pid_t> children;
+    for (int w = 0; w < workers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(jobPipe[1]);
+            close(resultPipe[0]);
+            MoveGenerator generator;
+            uint32_t job;
+            while (read(jobPipe[0], &job, sizeof(job)) == (ssize_t)sizeof(job)) {
+                char line[64];
+                int length = snprintf(line, sizeof(line), "%u %llu\n", job,
+                    (unsigned long long)runJob(generator, jobs[job]));
+                if (write(resultPipe[1], line, length) != length) _exit(1);
+            }
+            _exit(0);
+        }
+        if (pid > 0) children.push_back(pid);
+    }
+    close(jobPipe[0]);
+    close(resultPipe[1]);
+
+    // a thread feeds the jobs so that a full pipe can't block the results
+    std::thread feeder([&]() {
+        for (uint32_t job : pending) {
+            if (write(jobPipe[1], &job, sizeof(job)) != (ssize_t)sizeof(job)) break;
+        }
+        close(jobPipe[1]);
+    });
+
+    size_t received = 0;
+    FILE* results = fdopen(resultPipe[0], "r");
+    unsigned job;
+    unsigned long long nodes;
+    while (results && fscanf(results, "%u %llu", &job, &nodes) == 2) {
+        if (job < jobs.size()) {
+            finished(job, (uint64_t)nodes);
+            ++received;
+        }
+    }
+    if (results) fclose(results);
+    else close(resultPipe[0]);
+
+    feeder.join();
+    signal(SIGPIPE, previousSigpipe);
+    bool ok = !children.empty();
+    for (pid_t pid : children) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok && received == pending.size();
+#endif
+}
+
+bool shardedPerft(const board& Board, int depth, const ShardedPerftOptions& options,
+    ShardedPerftResult& result, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    result = ShardedPerftResult();
+
+    board root = Board;
+    MoveGenerator generator;
+    std::vector<PerftJob> jobs = perftJobs(generator, root, depth, options.splitDepth);
+    result.jobs = jobs.size();
+
+    std::map<std::string, uint64_t> done;
+    if (!options.checkpoint.empty()) readCheckpoint(options.checkpoint, done);
+
+    std::vector<uint32_t> pending;
+    for (uint32_t i = 0; i < jobs.size(); ++i) {
+        auto it = done.find(jobKey(jobs[i].fen, jobs[i].depth));
+        if (it != done.end()) {
+            result.nodes.add(it->second, jobs[i].multiplicity);
+            ++result.resumed;
+        }
+        else {
+            pending.push_back(i);
+        }
+    }
+
+    FILE* checkpoint = nullptr;
+    if (!options.checkpoint.empty() && !pending.empty()) {
+        checkpoint = fopen(options.checkpoint.c_str(), "a");
+        if (!checkpoint) {
+            error = "can't write checkpoint " + options.checkpoint;
+            return false;
+        }
+    }
+
+    int workers = options.workers > 0 ? options.workers : (int)std::thread::hardware_concurrency();
+    workers = std::max(1, std::min<int>(workers, (int)pending.size()));
+
+    bool writeFailed = false;
+    bool ok = pending.empty() || runWorkers(jobs, pending, workers, [&](uint32_t job, uint64_t nodes) {
+        result.nodes.add(nodes, jobs[job].multiplicity);
+        if (checkpoint) {
+            // on disk before it counts as done
+            fprintf(checkpoint, "%d %llu %s\n", jobs[job].depth, (unsigned long long)nodes, jobs[job].fen.c_str());
+            if (fflush(checkpoint) != 0) writeFailed = true;
+#ifndef _WIN32
+            fsync(fileno(checkpoint));
+#endif
+        }
+    });
+    if (checkpoint && fclose(checkpoint) != 0) writeFailed = true;
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (writeFailed) {
+        error = "can't write checkpoint " + options.checkpoint;
+        return false;
+    }
+    if (!ok) {
+        error = "a worker failed; rerun to finish the remaining jobs";
+        return false;
+    }
+    return true;
+}
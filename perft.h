@@ -0,0 +1,64 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "movegenerator.h"
+
+// Number of leaf nodes of the legal move tree of the given depth. The last
+// ply is bulk counted from the size of the move list.
+long long perft(MoveGenerator& generator, board& Board, int depth);
+
+// Leaf count below each root move, in generation order.
+std::vector<std::pair<Move, long long>> perftDivide(MoveGenerator& generator, board& Board, int depth);
+
+// ---- Sharded perft ----
+// Deep counts are split into subtree jobs: the tree is expanded splitDepth
+// plies from the root, and every position reached becomes a job keyed by
+// its FEN (without the clocks) and the depth left below it. Transpositions
+// share one job, counted as often as the root reaches it. Jobs run in
+// worker processes that append each finished job to a checkpoint file, so
+// an interrupted run picks up where it stopped.
+
+// Unsigned 128-bit counter: totals of very deep perfts overflow 64 bits.
+struct PerftCount {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    void add(uint64_t nodes, uint64_t times);   // += nodes * times
+    std::string toString() const;
+};
+
+struct PerftJob {
+    std::string fen;
+    int depth;              // plies left below fen
+    uint64_t multiplicity;  // root move sequences that lead to it
+};
+
+std::vector<PerftJob> perftJobs(MoveGenerator& generator, board& Board, int depth, int splitDepth);
+
+struct ShardedPerftOptions {
+    int splitDepth = 2;
+    int workers = 0;            // 0 = one per hardware thread
+    std::string checkpoint;     // empty = no checkpoint file
+};
+
+struct ShardedPerftResult {
+    PerftCount nodes;
+    size_t jobs = 0;
+    size_t resumed = 0;         // jobs already in the checkpoint file
+    double seconds = 0.0;
+};
+
+// Perft of Board to depth, split as above. False with a message in error if
+// the checkpoint can't be written or a worker fails; finished jobs stay in
+// the checkpoint for the next attempt. Workers are forked, so call this
+// from a process without other threads running (threads on Windows).
+bool shardedPerft(const board& Board, int depth, const ShardedPerftOptions& options,
+    ShardedPerftResult& result, std::string& error);
+
+#endif // PERFT_H
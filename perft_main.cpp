@@ -0,0 +1,64 @@
+// Headless sharded perft for very deep counts (no Qt).
+//
+//   perft <depth> [fen] [--split plies] [--workers n] [--checkpoint file]
+//
+// The root is split into subtree jobs --split plies deep (default 2), run
+// in --workers processes (default: one per hardware thread). With a
+// checkpoint file, finished jobs are appended to it as they complete and
+// skipped when the same command is run again after an interruption.
+
+#include "perft.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static void usage() {
+    printf("usage: perft <depth> [fen] [--split plies] [--workers n] [--checkpoint file]\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    int depth = std::atoi(argv[1]);
+    std::string fen = START_FEN;
+    ShardedPerftOptions options;
+
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--split") == 0 && i + 1 < argc) options.splitDepth = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) options.workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) options.checkpoint = argv[++i];
+        else if (argv[i][0] != '-') fen = argv[i];
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    board b;
+    try {
+        b.loadFEN(fen);
+    }
+    catch (const std::exception&) {
+        printf("invalid FEN: %s\n", fen.c_str());
+        return 1;
+    }
+
+    ShardedPerftResult result;
+    std::string error;
+    bool ok = shardedPerft(b, depth, options, result, error);
+
+    printf("jobs %zu (%zu from checkpoint), split %d plies\n", result.jobs, result.resumed, options.splitDepth);
+    if (!ok) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    printf("perft %d: %s nodes in %.3f s\n", depth, result.nodes.toString().c_str(), result.seconds);
+    return 0;
+}
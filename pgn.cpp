@@ -0,0 +1,319 @@
+#include "pgn.h"
+#include "notation.h"
+#include "mappedfile.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pgn {
+
+// ---- Records ----
+
+static int promotionCode(const Move& m) {
+    if (!m.wasPromotion) return 0;
+    switch (m.promotedTo) {
+    case WQ: case BQ: return 1;
+    case WR: case BR: return 2;
+    case WB: case BB: return 3;
+    default: return 4;
+    }
+}
+
+PositionRecord makeRecord(const board& Board, const Move& move, int ply, int gamePlies, Result result) {
+    PositionRecord r;
+    for (int i = 0; i < 32; ++i) {
+        r.pieces[i] = (uint8_t)(Board.currentState[2 * i] | (Board.currentState[2 * i + 1] << 4));
+    }
+    r.ply = (uint16_t)ply;
+    r.gamePlies = (uint16_t)gamePlies;
+    r.move = (uint16_t)(move.from | (move.to << 6) | (promotionCode(move) << 12));
+    r.fullmoveNumber = (uint16_t)Board.fullmoveNumber;
+    r.flags = (uint8_t)((Board.isWhiteTurn ? 1 : 0) | (Board.castleRights << 1));
+    r.enPassantSquare = (int8_t)(Board.hasEnPassant ? Board.enPassantSquare : -1);
+    r.halfmoveClock = (uint8_t)std::min(Board.halfmoveClock, 255);
+    r.result = result;
+    return r;
+}
+
+void loadRecord(const PositionRecord& r, board& Board) {
+    for (int i = 0; i < 32; ++i) {
+        Board.currentState[2 * i] = (Piece)(r.pieces[i] & 0x0F);
+        Board.currentState[2 * i + 1] = (Piece)(r.pieces[i] >> 4);
+    }
+    Board.isWhiteTurn = r.flags & 1;
+    Board.castleRights = (r.flags >> 1) & 0x0F;
+    Board.hasEnPassant = r.enPassantSquare >= 0;
+    Board.enPassantSquare = r.enPassantSquare;
+    Board.halfmoveClock = r.halfmoveClock;
+    Board.fullmoveNumber = r.fullmoveNumber;
+    Board.keyHistory.clear();
+    Board.zobristKey = Zobrist::compute(Board);
+    Board.recomputeEval();
+}
+
+uint64_t recordKey(const PositionRecord& r) {
+    const Zobrist::Keys& keys = Zobrist::KEYS;
+    uint64_t key = 0;
+    for (int i = 0; i < 32; ++i) {
+        key ^= keys.piece[r.pieces[i] & 0x0F][2 * i];
+        key ^= keys.piece[r.pieces[i] >> 4][2 * i + 1];
+    }
+    key ^= keys.castle[(r.flags >> 1) & 0x0F];
+    if (r.enPassantSquare >= 0) key ^= keys.enPassant[r.enPassantSquare];
+    if (!(r.flags & 1)) key ^= keys.side;
+    return key;
+}
+
+bool samePosition(const PositionRecord& a, const PositionRecord& b) {
+    return std::memcmp(a.pieces, b.pieces, sizeof(a.pieces)) == 0 && a.flags == b.flags
+        && a.enPassantSquare == b.enPassantSquare;
+}
+
+// ---- Movetext ----
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static bool parseResult(std::string_view token, Result& result) {
+    if (token == "1-0") result = WHITE_WINS;
+    else if (token == "0-1") result = BLACK_WINS;
+    else if (token == "1/2-1/2") result = DRAW;
+    else if (token == "*") result = UNKNOWN;
+    else return false;
+    return true;
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool replayGame(std::string_view text, board& Board, MoveGenerator& generator, Result& result,
+    const std::function<void(const board&, const Move&, int ply)>& visit) {
+    size_t pos = 0, n = text.size();
+    std::string_view fen = START_FEN;
+    result = UNKNOWN;
+    bool resultTag = false;
+
+    // ---- Tag pairs: [Name "value"] ----
+    for (;;) {
+        while (pos < n && isSpace(text[pos])) ++pos;
+        if (pos >= n || text[pos] != '[') break;
+
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = n;
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end;
+
+        size_t open = line.find('"'), close = line.rfind('"');
+        if (open == std::string_view::npos || close <= open) continue;
+        std::string_view name = line.substr(1, line.find(' ') - 1);
+        std::string_view value = line.substr(open + 1, close - open - 1);
+
+        if (name == "FEN") fen = value;
+        else if (name == "Result") resultTag = parseResult(value, result);
+    }
+
+    try {
+        Board.loadFEN(std::string(fen));
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+
+    // ---- Movetext ----
+    int ply = 0;
+    int variationDepth = 0;
+    while (pos < n) {
+        char c = text[pos];
+        if (isSpace(c)) {
+            ++pos;
+        }
+        else if (c == '{') {
+            size_t end = text.find('}', pos);
+            pos = end == std::string_view::npos ? n : end + 1;
+        }
+        else if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n'))) {
+            size_t end = text.find('\n', pos);
+            pos = end == std::string_view::npos ? n : end + 1;
+        }
+        else if (c == '(') {
+            ++variationDepth;
+            ++pos;
+        }
+        else if (c == ')') {
+            if (variationDepth == 0) return false;
+            --variationDepth;
+            ++pos;
+        }
+        else {
+            size_t start = pos;
+            while (pos < n && !isSpace(text[pos]) && !std::strchr("{}();", text[pos])) ++pos;
+            std::string_view token = text.substr(start, pos - start);
+            if (variationDepth > 0 || token[0] == '$') continue;
+
+            Result termination;
+            if (parseResult(token, termination)) {
+                if (!resultTag) result = termination;
+                break;
+            }
+
+            // move numbers, possibly run into the move: "12.", "12...", "12.e4";
+            // digits not followed by a dot are a move, e.g. castling as "0-0"
+            size_t skip = 0;
+            while (skip < token.size() && token[skip] >= '0' && token[skip] <= '9') ++skip;
+            if (skip > 0 && (skip == token.size() || token[skip] == '.')) {
+                while (skip < token.size() && token[skip] == '.') ++skip;
+                token.remove_prefix(skip);
+                if (token.empty()) continue;
+            }
+
+            Move m;
+            if (!parseSanMove(Board, generator, token, m)) return false;
+            visit(Board, m, ply);
+            Board.makeMove(m);
+            ++ply;
+        }
+    }
+    return variationDepth == 0;
+}
+
+// ---- Ingest ----
+
+static const char GAME_START[] = "\n[Event ";
+
+// First game start at or after pos: a line beginning with "[Event ".
+static size_t nextGame(std::string_view archive, size_t pos) {
+    if (pos == 0 && archive.compare(0, sizeof(GAME_START) - 2, GAME_START + 1) == 0) return 0;
+    size_t found = archive.find(GAME_START, pos == 0 ? 0 : pos - 1);
+    return found == std::string_view::npos ? archive.size() : found + 1;
+}
+
+static const char* resultText(Result r) {
+    switch (r) {
+    case WHITE_WINS: return "1-0";
+    case BLACK_WINS: return "0-1";
+    case DRAW: return "1/2-1/2";
+    default: return "*";
+    }
+}
+
+bool ingest(const std::string& pgnPath, const std::string& outPath, const IngestOptions& options,
+    IngestStats& stats, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    stats = IngestStats();
+
+    MappedFile file;
+    if (!file.open(pgnPath)) {
+        error = "can't map " + pgnPath;
+        return false;
+    }
+    FILE* out = fopen(outPath.c_str(), options.binary ? "wb" : "w");
+    if (!out) {
+        error = "can't write " + outPath;
+        return false;
+    }
+
+    std::string_view archive((const char*)file.data(), file.size());
+    stats.bytes = archive.size();
+
+    int threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+
+    std::mutex outputMutex;
+    bool writeFailed = false;
+    auto flush = [&](std::string& buffer) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size()) writeFailed = true;
+        buffer.clear();
+    };
+
+    auto worker = [&](int index, IngestStats& local) {
+        size_t begin = nextGame(archive, archive.size() * index / threads);
+        size_t end = nextGame(archive, archive.size() * (index + 1) / threads);
+
+        board b;
+        MoveGenerator generator;
+        std::string buffer, game;
+        std::vector<PositionRecord> records;
+
+        for (size_t gameStart = begin; gameStart < end; ) {
+            size_t gameEnd = nextGame(archive, gameStart + 1);
+            std::string_view text = archive.substr(gameStart, gameEnd - gameStart);
+            gameStart = gameEnd;
+
+            // a game's positions only go out once the whole game has parsed
+            records.clear();
+            game.clear();
+            Result result;
+            bool ok = replayGame(text, b, generator, result, [&](const board& position, const Move& m, int ply) {
+                if (options.binary) {
+                    records.push_back(makeRecord(position, m, ply, 0, UNKNOWN));
+                }
+                else {
+                    game += position.toFEN();
+                    game += ';';
+                    game += moveToUci(m);
+                    game += ";%;";
+                    game += std::to_string(ply);
+                    game += '\n';
+                }
+            });
+            if (!ok) {
+                ++local.skipped;
+                continue;
+            }
+
+            ++local.games;
+            if (options.binary) {
+                for (PositionRecord& r : records) {
+                    r.gamePlies = (uint16_t)records.size();
+                    r.result = result;
+                }
+                local.positions += records.size();
+                buffer.append((const char*)records.data(), records.size() * sizeof(PositionRecord));
+            }
+            else {
+                // the result is only known at the end of the movetext
+                const char* text = resultText(result);
+                for (size_t i = 0; i < game.size(); ++i) {
+                    if (game[i] == '%') {
+                        buffer += text;
+                        ++local.positions;
+                    }
+                    else {
+                        buffer += game[i];
+                    }
+                }
+            }
+            if (buffer.size() >= (1 << 20)) flush(buffer);
+        }
+        if (!buffer.empty()) flush(buffer);
+    };
+
+    std::vector<IngestStats> perThread(threads);
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker, i, std::ref(perThread[i]));
+    worker(0, perThread[0]);
+    for (auto& t : pool) t.join();
+
+    for (const IngestStats& s : perThread) {
+        stats.games += s.games;
+        stats.skipped += s.skipped;
+        stats.positions += s.positions;
+    }
+    if (fclose(out) != 0) writeFailed = true;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (writeFailed) {
+        error = "can't write " + outPath;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Pgn
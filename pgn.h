@@ -0,0 +1,77 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "board.h"
+#include "movegenerator.h"
+
+// PGN archive ingest: replays every game and writes out the positions in it.
+//
+// The archive is memory-mapped and cut into one range per thread; a range
+// is moved forward to the next "[Event " line, so every game is read by
+// exactly one thread, on a board of its own. Movetext comments, variations,
+// NAGs and move numbers are skipped; moves are read with parseSanMove.
+// A game with a move that doesn't parse, or a FEN tag that doesn't load,
+// is counted as skipped and the run goes on with the next game.
+namespace Pgn {
+
+enum Result : int8_t { BLACK_WINS = -1, DRAW = 0, WHITE_WINS = 1, UNKNOWN = 2 };
+
+// One position, the move played from it and the game's result: the binary
+// output format, written in host byte order.
+struct PositionRecord {
+    uint8_t pieces[32];     // Piece of square 2i in the low nibble, 2i+1 in the high one
+    uint16_t ply;           // half-moves since the start of the game
+    uint16_t gamePlies;     // length of the game
+    uint16_t move;          // from | to << 6 | promotion << 12 (0 none, 1 Q, 2 R, 3 B, 4 N)
+    uint16_t fullmoveNumber;
+    uint8_t flags;          // bit 0 white to move, bits 1-4 castling rights
+    int8_t enPassantSquare; // -1 for none
+    uint8_t halfmoveClock;
+    int8_t result;          // Result, from white's side
+};
+static_assert(sizeof(PositionRecord) == 44, "PositionRecord must stay packed");
+
+PositionRecord makeRecord(const board& Board, const Move& move, int ply, int gamePlies, Result result);
+// Sets Board to the record's position.
+void loadRecord(const PositionRecord& record, board& Board);
+// board::zobristKey of the record's position, without loading it.
+uint64_t recordKey(const PositionRecord& record);
+// Same pieces, side to move, castling rights and en passant square.
+bool samePosition(const PositionRecord& a, const PositionRecord& b);
+
+// Replays one game's text (tags and movetext). visit is called for every
+// position before a move, with the move and its ply. False if the game is
+// malformed; positions before the bad move have been visited by then.
+bool replayGame(std::string_view text, board& Board, MoveGenerator& generator, Result& result,
+    const std::function<void(const board&, const Move&, int ply)>& visit);
+
+struct IngestOptions {
+    int threads = 0;        // 0 = one per hardware thread
+    bool binary = false;    // PositionRecords instead of text lines
+};
+
+struct IngestStats {
+    long long games = 0;
+    long long skipped = 0;  // malformed games
+    long long positions = 0;
+    size_t bytes = 0;       // size of the archive
+    double seconds = 0.0;
+};
+
+// Writes the positions of every game in pgnPath to outPath. Text lines are
+// "<fen>;<uci move>;<result>;<ply>", result being 1-0, 0-1, 1/2-1/2 or *.
+// Positions of one game stay together and in order; games come out in the
+// order the threads finish them. False with a message in error if a file
+// can't be opened or written.
+bool ingest(const std::string& pgnPath, const std::string& outPath, const IngestOptions& options,
+    IngestStats& stats, std::string& error);
+
+} // namespace Pgn
+
+#endif // PGN_H
@@ -0,0 +1,646 @@
+#include "tablebase.h"
+#include "movegenerator.h"
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Tablebase {
+
+// ---- Material ----
+
+static const char* PIECE_LETTERS = "QRBNP";     // order of a side's pieces after the king
+
+struct Material {
+    std::string name;
+    std::string white, black;   // pieces besides the king, in PIECE_LETTERS order
+    int count = 0;
+    Piece pieces[MAX_PIECES];   // white king, black king, white's pieces, black's pieces
+    bool pawns = false;
+    bool duplicates = false;    // two identical pieces besides the kings
+    uint64_t size = 0;          // entries in the table
+};
+
+static Piece pieceFromLetter(char c, bool white) {
+    switch (c) {
+    case 'Q': return white ? WQ : BQ;
+    case 'R': return white ? WR : BR;
+    case 'B': return white ? WB : BB;
+    case 'N': return white ? WN : BN;
+    case 'P': return white ? WP : BP;
+    }
+    return EMPTY;
+}
+
+static Piece flipColor(Piece p) {
+    if (p == EMPTY) return EMPTY;
+    return p >= WQ ? Piece(p - 6) : Piece(p + 6);
+}
+
+// The letters of side in PIECE_LETTERS order; false if there are others.
+static bool sortSide(const std::string& side, std::string& sorted) {
+    sorted.clear();
+    for (const char* c = PIECE_LETTERS; *c; ++c) {
+        sorted.append(std::count(side.begin(), side.end(), *c), *c);
+    }
+    return sorted.size() == side.size();
+}
+
+static bool parseMaterial(const std::string& name, Material& m, std::string& error) {
+    size_t second = name.empty() ? std::string::npos : name.find('K', 1);
+    if (name[0] != 'K' || second == std::string::npos
+        || !sortSide(name.substr(1, second - 1), m.white)
+        || !sortSide(name.substr(second + 1), m.black)) {
+        error = "bad material '" + name + "', expected e.g. KRPKR";
+        return false;
+    }
+    if (2 + m.white.size() + m.black.size() > (size_t)MAX_PIECES) {
+        error = "more than " + std::to_string(MAX_PIECES) + " pieces in " + name;
+        return false;
+    }
+
+    m.name = "K" + m.white + "K" + m.black;
+    m.count = 0;
+    m.pieces[m.count++] = WK;
+    m.pieces[m.count++] = BK;
+    for (char c : m.white) m.pieces[m.count++] = pieceFromLetter(c, true);
+    for (char c : m.black) m.pieces[m.count++] = pieceFromLetter(c, false);
+    m.pawns = (m.white + m.black).find('P') != std::string::npos;
+    m.duplicates = false;
+    for (int i = 3; i < m.count; ++i) {
+        if (m.pieces[i] == m.pieces[i - 1]) m.duplicates = true;
+    }
+
+    m.size = 2 * (m.pawns ? 32 : 10);
+    for (int i = 1; i < m.count; ++i) {
+        m.size *= (m.pieces[i] == WP || m.pieces[i] == BP) ? 48 : 64;
+    }
+    return true;
+}
+
+static std::string flippedName(const std::string& name) {
+    size_t second = name.find('K', 1);
+    return name.substr(second) + name.substr(0, second);
+}
+
+static std::string sideName(const board& Board, bool white) {
+    std::string s = "K";
+    for (const char* c = PIECE_LETTERS; *c; ++c) {
+        s.append(Board.pieceCount[pieceFromLetter(*c, white)], *c);
+    }
+    return s;
+}
+
+// Letter strings compare by value: Q < R < B < N < P.
+static bool strongerSide(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return a.size() > b.size();
+    for (size_t i = 0; i < a.size(); ++i) {
+        const char* pa = std::strchr(PIECE_LETTERS, a[i]);
+        const char* pb = std::strchr(PIECE_LETTERS, b[i]);
+        if (pa != pb) return pa < pb;
+    }
+    return true;
+}
+
+// Material name with the stronger side as white, the orientation
+// generated tables use.
+static std::string tableName(const std::string& white, const std::string& black) {
+    return strongerSide(white, black) ? "K" + white + "K" + black : "K" + black + "K" + white;
+}
+
+// Materials reached by one capture or promotion.
+static std::vector<std::string> dependencies(const Material& m) {
+    std::vector<std::string> names;
+
+    for (int side = 0; side < 2; ++side) {
+        const std::string& own = side == 0 ? m.white : m.black;
+        const std::string& other = side == 0 ? m.black : m.white;
+
+        for (size_t i = 0; i < own.size(); ++i) {
+            if (i > 0 && own[i] == own[i - 1]) continue;
+            std::string rest = own.substr(0, i) + own.substr(i + 1);
+
+            std::string replacements = own[i] == 'P' ? "QRBN" : "";
+            replacements += ' ';    // the piece is captured
+            for (char r : replacements) {
+                std::string changed;
+                sortSide(r == ' ' ? rest : rest + r, changed);
+                names.push_back(tableName(changed, other));
+            }
+        }
+    }
+    return names;
+}
+
+// ---- Indexing ----
+
+// Squares a pawnless table keeps the white king on: r <= c <= 3, the
+// smallest square of every orbit under the board symmetries.
+struct KingTriangle {
+    int slot[64];
+    int square[10];
+
+    constexpr KingTriangle() : slot(), square() {
+        int n = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            int r = sq / 8, c = sq % 8;
+            slot[sq] = (r <= c && c <= 3) ? n : -1;
+            if (slot[sq] >= 0) square[n++] = sq;
+        }
+    }
+};
+
+static constexpr KingTriangle TRIANGLE{};
+
+// Symmetry t: bit 2 transposes, bit 1 flips the rows, bit 0 the files.
+static int transform(int sq, int t) {
+    int r = sq / 8, c = sq % 8;
+    if (t & 4) std::swap(r, c);
+    if (t & 2) r = 7 - r;
+    if (t & 1) c = 7 - c;
+    return r * 8 + c;
+}
+
+// Identical pieces are interchangeable: keep their squares in ascending order.
+static void sortIdentical(const Material& m, int* sq) {
+    for (int i = 2; i < m.count; ) {
+        int j = i + 1;
+        while (j < m.count && m.pieces[j] == m.pieces[i]) ++j;
+        std::sort(sq + i, sq + j);
+        i = j;
+    }
+}
+
+// Replaces sq with the smallest image of the position under the symmetries
+// the material allows, so that every orbit has exactly one index in use.
+static void canonicalize(const Material& m, int* sq) {
+    // the white king comes first, so only the symmetries taking it to its
+    // smallest image can win: one, or two with the king on a diagonal
+    int symmetries = m.pawns ? 2 : 8;
+    int king = 64;
+    for (int t = 0; t < symmetries; ++t) king = std::min(king, transform(sq[0], t));
+
+    int best[MAX_PIECES];
+    bool found = false;
+    for (int t = 0; t < symmetries; ++t) {
+        if (transform(sq[0], t) != king) continue;
+        int image[MAX_PIECES];
+        for (int i = 0; i < m.count; ++i) image[i] = transform(sq[i], t);
+        if (m.duplicates) sortIdentical(m, image);
+        if (!found || std::lexicographical_compare(image, image + m.count, best, best + m.count)) {
+            std::copy(image, image + m.count, best);
+            found = true;
+        }
+    }
+    std::copy(best, best + m.count, sq);
+}
+
+// sq must be canonical.
+static uint64_t index(const Material& m, const int* sq, bool whiteToMove) {
+    uint64_t idx = m.pawns ? (sq[0] / 8) * 4 + sq[0] % 8 : TRIANGLE.slot[sq[0]];
+    for (int i = 1; i < m.count; ++i) {
+        bool pawn = m.pieces[i] == WP || m.pieces[i] == BP;
+        idx = idx * (pawn ? 48 : 64) + (pawn ? sq[i] - 8 : sq[i]);    // pawns on rows 1-6
+    }
+    // side to move on top: neighbouring entries then differ in the last
+    // piece's square only, which keeps the runs long
+    return whiteToMove ? idx + m.size / 2 : idx;
+}
+
+static void decode(const Material& m, uint64_t idx, int* sq, bool& whiteToMove) {
+    uint64_t half = m.size / 2;
+    whiteToMove = idx >= half;
+    if (whiteToMove) idx -= half;
+    for (int i = m.count - 1; i >= 1; --i) {
+        bool pawn = m.pieces[i] == WP || m.pieces[i] == BP;
+        int radix = pawn ? 48 : 64;
+        sq[i] = (int)(idx % radix) + (pawn ? 8 : 0);
+        idx /= radix;
+    }
+    sq[0] = m.pawns ? (int)(idx / 4) * 8 + (int)(idx % 4) : TRIANGLE.square[idx];
+}
+
+// ---- Table files ----
+// Header: magic, material name (16 bytes, zero padded), entry count (u64).
+// Then u32 block offsets into the data, one per block plus the end, and
+// the blocks: runs of (value, LEB128 length). A value is 0 for a draw or
+// an unused index, else plies to mate + 1. Little-endian throughout.
+
+static constexpr char MAGIC[8] = { 'C', 'M', 'G', 'T', 'B', '1', 0, 0 };
+static constexpr size_t HEADER_SIZE = 32;
+
+struct Table {
+    Material material;
+    MappedFile file;
+    uint64_t entries = 0;
+    const uint32_t* offsets = nullptr;
+    const uint8_t* data = nullptr;
+};
+
+static std::map<std::string, std::unique_ptr<Table>> tables;
+static int largest = 0;
+
+static bool openTable(const std::string& path) {
+    std::unique_ptr<Table> t(new Table());
+    if (!t->file.open(path) || t->file.size() < HEADER_SIZE) return false;
+
+    const uint8_t* p = t->file.data();
+    char name[17] = {};
+    std::memcpy(name, p + 8, 16);
+    std::memcpy(&t->entries, p + 24, 8);
+    std::string error;
+    if (std::memcmp(p, MAGIC, 8) != 0 || !parseMaterial(name, t->material, error)
+        || t->entries != t->material.size) {
+        return false;
+    }
+
+    uint64_t blocks = (t->entries + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES;
+    size_t dataStart = HEADER_SIZE + (blocks + 1) * sizeof(uint32_t);
+    if (t->file.size() < dataStart) return false;
+    t->offsets = (const uint32_t*)(p + HEADER_SIZE);    // the mapping is page aligned
+    t->data = p + dataStart;
+    if (dataStart + t->offsets[blocks] != t->file.size()) return false;
+
+    largest = std::max(largest, t->material.count);
+    tables[t->material.name] = std::move(t);
+    return true;
+}
+
+static int readEntry(const Table& t, uint64_t idx) {
+    const uint8_t* p = t.data + t.offsets[idx / BLOCK_ENTRIES];
+    uint32_t skip = (uint32_t)(idx % BLOCK_ENTRIES);
+    for (;;) {
+        uint8_t value = *p++;
+        uint32_t length = 0;
+        for (int shift = 0; ; shift += 7) {
+            length |= (uint32_t)(*p & 0x7F) << shift;
+            if (!(*p++ & 0x80)) break;
+        }
+        if (skip < length) return value;
+        skip -= length;
+    }
+}
+
+int load(const std::string& directory) {
+    int found = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == ".cmgtb" && openTable(entry.path().string())) ++found;
+    }
+    return found;
+}
+
+void unload() {
+    tables.clear();
+    largest = 0;
+}
+
+int maxPieces() {
+    return largest;
+}
+
+bool probe(const board& Board, ProbeResult& result) {
+    if (Board.castleRights != 0) return false;
+
+    std::string name = sideName(Board, true) + sideName(Board, false);
+    if (name == "KK") {
+        result = ProbeResult();
+        return true;
+    }
+
+    bool flipped = false;
+    auto it = tables.find(name);
+    if (it == tables.end()) {
+        flipped = true;
+        it = tables.find(flippedName(name));
+        if (it == tables.end()) return false;
+    }
+    const Table& t = *it->second;
+    const Material& m = t.material;
+
+    // squares in table order; identical pieces in any order
+    int sq[MAX_PIECES];
+    bool taken[MAX_PIECES] = {};
+    for (int s = 0; s < 64; ++s) {
+        Piece p = Board.currentState[s];
+        if (p == EMPTY) continue;
+        if (flipped) p = flipColor(p);
+        for (int i = 0; i < m.count; ++i) {
+            if (!taken[i] && m.pieces[i] == p) {
+                sq[i] = flipped ? s ^ 56 : s;
+                taken[i] = true;
+                break;
+            }
+        }
+    }
+
+    canonicalize(m, sq);
+    int value = readEntry(t, index(m, sq, Board.isWhiteTurn != flipped));
+    result.plies = value > 0 ? value - 1 : 0;
+    result.wdl = value == 0 ? DRAW : (result.plies & 1) ? WIN : LOSS;
+    return true;
+}
+
+// ---- Generation ----
+
+static constexpr uint16_t UNKNOWN = 0xFFFF;
+static constexpr uint16_t INVALID = 0xFFFE;
+static constexpr uint64_t CHUNK = 1 << 16;
+
+// Runs work(begin, end, board, generator) over CHUNK-sized pieces of
+// [0, size), handed out to threads as they become free.
+template <typename Work>
+static void parallelChunks(uint64_t size, int threads, Work work) {
+    std::atomic<uint64_t> next{ 0 };
+    auto run = [&]() {
+        board b;
+        MoveGenerator generator;
+        for (;;) {
+            uint64_t begin = next.fetch_add(CHUNK);
+            if (begin >= size) break;
+            work(begin, std::min(size, begin + CHUNK), b, generator);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(run);
+    run();
+    for (auto& t : pool) t.join();
+}
+
+static void raiseTo(std::atomic<int>& target, int v) {
+    int cur = target.load(std::memory_order_relaxed);
+    while (cur < v && !target.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+// Values in plies to mate: odd for a win of the side to move, even for a loss.
+struct Solver {
+    const Material& m;
+    uint64_t size;
+    int threads;
+    std::unique_ptr<std::atomic<uint16_t>[]> value;
+    std::unique_ptr<std::atomic<uint8_t>[]> remaining;     // in-table successors not yet won by the opponent
+    std::vector<uint8_t> canDraw;       // a move draws: stalemate or a drawn capture/promotion
+    std::vector<uint16_t> exitLoss;     // longest opponent win after a capture/promotion
+    std::atomic<int> maxValue{ 0 };
+    std::atomic<bool> missingTable{ false };
+
+    Solver(const Material& material, int threadCount)
+        : m(material), size(material.size), threads(threadCount),
+        value(new std::atomic<uint16_t>[size]), remaining(new std::atomic<uint8_t>[size]),
+        canDraw(size), exitLoss(size) {}
+
+    void initialize(uint64_t idx, board& b, MoveGenerator& generator,
+        std::vector<Move>& moves, std::vector<uint64_t>& successors);
+    void retract(uint64_t idx, int d, board& b, MoveGenerator& generator,
+        std::vector<Move>& unmoves, std::vector<uint64_t>& predecessors);
+    void run();
+};
+
+void Solver::initialize(uint64_t idx, board& b, MoveGenerator& generator,
+    std::vector<Move>& moves, std::vector<uint64_t>& successors) {
+    value[idx].store(INVALID, std::memory_order_relaxed);
+    remaining[idx].store(0, std::memory_order_relaxed);
+
+    int sq[MAX_PIECES], canonical[MAX_PIECES];
+    bool whiteToMove;
+    decode(m, idx, sq, whiteToMove);
+
+    for (int i = 0; i < m.count; ++i) {
+        for (int j = 0; j < i; ++j) {
+            if (sq[i] == sq[j]) return;
+        }
+    }
+    std::copy(sq, sq + m.count, canonical);
+    canonicalize(m, canonical);
+    if (!std::equal(sq, sq + m.count, canonical)) return;
+
+    b.setPosition(m.pieces, sq, m.count, whiteToMove);
+    // the side not to move can't be in check (this covers touching kings)
+    if (generator.isSquareAttacked(b, sq[whiteToMove ? 1 : 0], whiteToMove)) return;
+
+    generator.generateLegalMoves(b, moves);
+    if (moves.empty()) {
+        if (generator.isSquareAttacked(b, sq[whiteToMove ? 0 : 1], !whiteToMove)) {
+            value[idx].store(0, std::memory_order_relaxed);     // mated
+        }
+        else {
+            value[idx].store(UNKNOWN, std::memory_order_relaxed);
+            canDraw[idx] = 1;
+        }
+        return;
+    }
+
+    int exitWin = UNKNOWN;
+    successors.clear();
+    for (const Move& mv : moves) {
+        if (mv.captured != EMPTY || mv.wasPromotion) {
+            // leaves the table: the smaller table has the answer
+            Unmove u = b.makeMove(mv);
+            ProbeResult r;
+            bool found = probe(b, r);
+            b.unmakeMove(mv, u);
+
+            if (!found) missingTable = true;
+            else if (r.wdl == DRAW) canDraw[idx] = 1;
+            else if (r.wdl == LOSS) exitWin = std::min(exitWin, r.plies + 1);
+            else exitLoss[idx] = std::max<int>(exitLoss[idx], r.plies);
+            continue;
+        }
+
+        int next[MAX_PIECES];
+        std::copy(sq, sq + m.count, next);
+        for (int i = 0; i < m.count; ++i) {
+            if (next[i] == mv.from) next[i] = mv.to;
+        }
+        canonicalize(m, next);
+        successors.push_back(index(m, next, !whiteToMove));
+    }
+
+    std::sort(successors.begin(), successors.end());
+    successors.erase(std::unique(successors.begin(), successors.end()), successors.end());
+    remaining[idx].store((uint8_t)successors.size(), std::memory_order_relaxed);
+
+    uint16_t v = UNKNOWN;
+    if (exitWin != UNKNOWN) v = (uint16_t)exitWin;
+    else if (successors.empty() && !canDraw[idx]) v = exitLoss[idx] + 1;
+    value[idx].store(v, std::memory_order_relaxed);
+    if (v != UNKNOWN) raiseTo(maxValue, v);
+}
+
+// Passes the value d of idx on to the positions one move before it.
+void Solver::retract(uint64_t idx, int d, board& b, MoveGenerator& generator,
+    std::vector<Move>& unmoves, std::vector<uint64_t>& predecessors) {
+    int sq[MAX_PIECES];
+    bool whiteToMove;
+    decode(m, idx, sq, whiteToMove);
+    b.setPosition(m.pieces, sq, m.count, whiteToMove);
+    generator.generateUnmoves(b, unmoves);
+
+    predecessors.clear();
+    for (const Move& u : unmoves) {
+        int prev[MAX_PIECES];
+        std::copy(sq, sq + m.count, prev);
+        for (int i = 0; i < m.count; ++i) {
+            if (prev[i] == u.to) prev[i] = u.from;
+        }
+        canonicalize(m, prev);
+        predecessors.push_back(index(m, prev, !whiteToMove));
+    }
+    std::sort(predecessors.begin(), predecessors.end());
+    predecessors.erase(std::unique(predecessors.begin(), predecessors.end()), predecessors.end());
+
+    for (uint64_t p : predecessors) {
+        if ((d & 1) == 0) {
+            // the mover there can reach a lost position: won in d + 1,
+            // unless an exit already wins faster
+            uint16_t cur = value[p].load(std::memory_order_relaxed);
+            while (cur > d + 1 && cur != INVALID
+                && !value[p].compare_exchange_weak(cur, (uint16_t)(d + 1), std::memory_order_relaxed)) {}
+            raiseTo(maxValue, d + 1);
+        }
+        else if (remaining[p].fetch_sub(1, std::memory_order_relaxed) == 1 && !canDraw[p]) {
+            // every move now loses; the longest line decides the distance
+            uint16_t v = (uint16_t)(std::max<int>(d, exitLoss[p]) + 1);
+            uint16_t expected = UNKNOWN;
+            if (value[p].compare_exchange_strong(expected, v, std::memory_order_relaxed)) {
+                raiseTo(maxValue, v);
+            }
+        }
+    }
+}
+
+void Solver::run() {
+    parallelChunks(size, threads, [this](uint64_t begin, uint64_t end, board& b, MoveGenerator& generator) {
+        std::vector<Move> moves;
+        std::vector<uint64_t> successors;
+        for (uint64_t idx = begin; idx < end; ++idx) {
+            initialize(idx, b, generator, moves, successors);
+        }
+    });
+
+    for (int d = 0; d <= maxValue.load(); ++d) {
+        parallelChunks(size, threads, [this, d](uint64_t begin, uint64_t end, board& b, MoveGenerator& generator) {
+            std::vector<Move> unmoves;
+            std::vector<uint64_t> predecessors;
+            for (uint64_t idx = begin; idx < end; ++idx) {
+                if (value[idx].load(std::memory_order_relaxed) == d) {
+                    retract(idx, d, b, generator, unmoves, predecessors);
+                }
+            }
+        });
+    }
+}
+
+static void appendRun(std::vector<uint8_t>& out, uint8_t value, uint32_t length) {
+    out.push_back(value);
+    do {
+        uint8_t byte = length & 0x7F;
+        length >>= 7;
+        out.push_back(byte | (length ? 0x80 : 0));
+    } while (length);
+}
+
+static bool writeTable(const std::string& path, const Solver& s, std::string& error) {
+    uint64_t blocks = (s.size + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> data;
+    uint8_t previous = 0;
+
+    for (uint64_t block = 0; block < blocks; ++block) {
+        offsets.push_back((uint32_t)data.size());
+        uint64_t end = std::min(s.size, (block + 1) * BLOCK_ENTRIES);
+        uint8_t runValue = 0;
+        uint32_t runLength = 0;
+
+        for (uint64_t idx = block * BLOCK_ENTRIES; idx < end; ++idx) {
+            uint16_t v = s.value[idx].load(std::memory_order_relaxed);
+            if (v < UNKNOWN - 1 && v > MAX_PLIES) {
+                error = "a mate in " + s.m.name + " is longer than " + std::to_string(MAX_PLIES) + " plies";
+                return false;
+            }
+            // unused indices continue the current run
+            uint8_t byte = v == INVALID ? previous : v == UNKNOWN ? 0 : (uint8_t)(v + 1);
+            previous = byte;
+
+            if (runLength > 0 && byte != runValue) {
+                appendRun(data, runValue, runLength);
+                runLength = 0;
+            }
+            runValue = byte;
+            ++runLength;
+        }
+        appendRun(data, runValue, runLength);
+        if (data.size() > 0xFFFFFFFFull) {
+            error = s.m.name + " is too large for 32-bit block offsets";
+            return false;
+        }
+    }
+    offsets.push_back((uint32_t)data.size());
+
+    uint8_t header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, 8);
+    std::memcpy(header + 8, s.m.name.c_str(), s.m.name.size());
+    std::memcpy(header + 24, &s.size, 8);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        error = "can't write " + path;
+        return false;
+    }
+    bool ok = fwrite(header, 1, HEADER_SIZE, f) == HEADER_SIZE
+        && fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), f) == offsets.size()
+        && fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) error = "can't write " + path;
+    return ok;
+}
+
+static bool generateTable(const Material& m, const std::string& directory, int threads, std::string& error) {
+    if (tables.count(m.name) || tables.count(flippedName(m.name))) return true;
+
+    std::string path = directory + "/" + m.name + ".cmgtb";
+    if (openTable(path) || openTable(directory + "/" + flippedName(m.name) + ".cmgtb")) return true;
+
+    for (const std::string& name : dependencies(m)) {
+        Material smaller;
+        if (name == "KK") continue;
+        if (!parseMaterial(name, smaller, error) || !generateTable(smaller, directory, threads, error)) {
+            return false;
+        }
+    }
+
+    Solver solver(m, threads);
+    solver.run();
+    if (solver.missingTable) {
+        error = "a table " + m.name + " depends on is missing";
+        return false;
+    }
+    if (!writeTable(path, solver, error)) return false;
+    if (!openTable(path)) {
+        error = "can't map " + path;
+        return false;
+    }
+    return true;
+}
+
+bool generate(const std::string& material, const std::string& directory, int threads, std::string& error) {
+    Material m;
+    if (!parseMaterial(material, m, error)) return false;
+
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    return generateTable(m, directory, threads, error);
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <string>
+
+#include "board.h"
+
+// Distance-to-mate endgame tablebases for small material sets, named by
+// white's pieces then black's: "KQK", "KRK", "KBNK", "KRPKR", "KRRK".
+//
+// generate() solves a set by retrograde analysis. Every position gets its
+// legal moves from MoveGenerator; mates are scored, and values then spread
+// backwards one ply per round through MoveGenerator::generateUnmoves, each
+// round split into chunks of the index space over several threads.
+// Captures and promotions leave the set and are scored from the smaller
+// tables, which are generated first.
+//
+// Positions are indexed after symmetry reduction: all 8 board symmetries
+// for pawnless sets (white king in the a8-d8-d5 triangle), the file mirror
+// with pawns (white king on files a-d); identical pieces are
+// interchangeable. Castling and en passant rights are not represented.
+//
+// Tables are stored as <material>.cmgtb files, run-length compressed in
+// blocks of BLOCK_ENTRIES entries with an offset table, and probed through
+// a memory mapping.
+namespace Tablebase {
+
+    enum Wdl { LOSS = -1, DRAW = 0, WIN = 1 };
+
+    struct ProbeResult {
+        Wdl wdl = DRAW;
+        int plies = 0;      // to mate for WIN and LOSS; 0 = the side to move is mated
+    };
+
+    static constexpr int MAX_PIECES = 5;
+    static constexpr int BLOCK_ENTRIES = 256;
+    static constexpr int MAX_PLIES = 254;   // longest mate a table can store
+
+    // Generates material and every table its captures and promotions lead
+    // to, reusing tables already in directory, and loads them. threads = 0
+    // uses all hardware threads. False with a message in error on failure.
+    bool generate(const std::string& material, const std::string& directory, int threads, std::string& error);
+
+    // Maps every table file in directory, in addition to those already
+    // loaded. Returns the number of tables found.
+    int load(const std::string& directory);
+    void unload();
+
+    // Most pieces in any loaded table, 0 if none is loaded.
+    int maxPieces();
+
+    // False if no loaded table covers Board's material or Board has
+    // castling rights.
+    bool probe(const board& Board, ProbeResult& result);
+}
+
+#endif // TABLEBASE_H
@@ -0,0 +1,114 @@
+#include "transpositiontable.h"
+
+// data layout:
+//   bits  0-15  packed move
+//   bits 16-31  score (int16)
+//   bits 32-39  depth
+//   bits 40-41  bound
+//   bits 42-49  generation
+
+static inline uint64_t packData(uint16_t move, int score, int depth, int bound, uint8_t generation) {
+    return (uint64_t)move
+        | ((uint64_t)(uint16_t)(int16_t)score << 16)
+        | ((uint64_t)(uint8_t)depth << 32)
+        | ((uint64_t)(bound & 3) << 40)
+        | ((uint64_t)generation << 42);
+}
+
+static inline uint16_t dataMove(uint64_t d) { return (uint16_t)d; }
+static inline int dataScore(uint64_t d) { return (int16_t)(uint16_t)(d >> 16); }
+static inline int dataDepth(uint64_t d) { return (uint8_t)(d >> 32); }
+static inline int dataBound(uint64_t d) { return (int)((d >> 40) & 3); }
+static inline uint8_t dataGeneration(uint64_t d) { return (uint8_t)(d >> 42); }
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t mb) {
+    if (mb < 1) mb = 1;
+
+    // round down to a power of two so the index is a mask
+    size_t count = (mb * 1024 * 1024) / sizeof(Entry);
+    size_t pow2 = 1;
+    while (pow2 * 2 <= count) pow2 *= 2;
+
+    table.reset(new Entry[pow2]);
+    entryCount = pow2;
+    megabytes = mb;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < entryCount; ++i) {
+        table[i].check.store(0, std::memory_order_relaxed);
+        table[i].data.store(0, std::memory_order_relaxed);
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation = (generation + 1) & 0xFF;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& out) const {
+    const Entry& e = table[key & (entryCount - 1)];
+
+    uint64_t data = e.data.load(std::memory_order_relaxed);
+    uint64_t check = e.check.load(std::memory_order_relaxed);
+
+    if ((check ^ data) != key || dataBound(data) == TT_NONE) {
+        return false;
+    }
+
+    out.move = dataMove(data);
+    out.score = dataScore(data);
+    out.depth = dataDepth(data);
+    out.bound = dataBound(data);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, int bound, uint16_t move) {
+    Entry& e = table[key & (entryCount - 1)];
+
+    uint64_t old = e.data.load(std::memory_order_relaxed);
+    bool sameKey = (e.check.load(std::memory_order_relaxed) ^ old) == key;
+
+    if (depth < 0) depth = 0;
+    if (depth > 255) depth = 255;
+
+    // Replace entries from older searches, shallower entries, or anything
+    // for the same position unless it would throw away much deeper work.
+    if (dataBound(old) != TT_NONE && dataGeneration(old) == generation) {
+        if (sameKey) {
+            if (bound != TT_EXACT && depth + 2 < dataDepth(old)) return;
+        }
+        else if (depth < dataDepth(old)) {
+            return;
+        }
+    }
+
+    // keep the old best move if we have none for this position
+    if (move == 0 && sameKey) {
+        move = dataMove(old);
+    }
+
+    uint64_t data = packData(move, score, depth, bound, generation);
+    e.data.store(data, std::memory_order_relaxed);
+    e.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0;
+    size_t sample = entryCount < 1000 ? entryCount : 1000;
+    for (size_t i = 0; i < sample; ++i) {
+        uint64_t d = table[i].data.load(std::memory_order_relaxed);
+        if (dataBound(d) != TT_NONE && dataGeneration(d) == generation) ++used;
+    }
+    return sample ? (int)(used * 1000 / sample) : 0;
+}
+
+uint16_t TranspositionTable::packMove(const Move& m) {
+    int promo = m.wasPromotion ? (int)m.promotedTo : 0;
+    return (uint16_t)(m.from | (m.to << 6) | (promo << 12));
+}
@@ -0,0 +1,58 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "board.h"
+
+enum TTBound {
+    TT_NONE = 0,
+    TT_UPPER = 1,   // fail-low: score is an upper bound
+    TT_LOWER = 2,   // fail-high: score is a lower bound
+    TT_EXACT = 3
+};
+
+struct TTData {
+    uint16_t move;  // packed with packMove, 0 = no move
+    int score;
+    int depth;
+    int bound;
+};
+
+// Shared hash table. Every search thread reads and writes it concurrently
+// without locks: each slot stores (key ^ data, data) so a torn write from two
+// racing threads fails the key check on probe instead of returning garbage.
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    void resize(size_t megabytes);
+    void clear();
+    void newSearch();
+
+    bool probe(uint64_t key, TTData& out) const;
+    void store(uint64_t key, int depth, int score, int bound, uint16_t move);
+
+    int hashfull() const;   // permille of slots written during this search
+    size_t sizeMB() const { return megabytes; }
+
+    static uint16_t packMove(const Move& m);
+    static bool sameMove(uint16_t packed, const Move& m) { return packed != 0 && packed == packMove(m); }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Entry[]> table;
+    size_t entryCount = 0;
+    size_t megabytes = 0;
+    uint8_t generation = 0;
+};
+
+#endif // TRANSPOSITIONTABLE_H
@@ -0,0 +1,394 @@
+#include "uci.h"
+#include "notation.h"
+#include "perft.h"
+#include "instrument.h"
+#include "nnue.h"
+#include "tablebase.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static constexpr int MAX_HASH_MB = 4096;
+static constexpr int DEFAULT_MOVES_TO_GO = 30;
+static constexpr int MOVE_OVERHEAD_MS = 50;     // kept back for GUI and pipe latency
+static constexpr int MATE_SOLVER_MB = 64;
+
+UciEngine::UciEngine() {
+    Board.loadFEN(START_FEN);
+}
+
+UciEngine::~UciEngine() {
+    stopSearch();
+}
+
+void UciEngine::loop(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!handleCommand(line)) break;
+    }
+    stopSearch();
+}
+
+bool UciEngine::handleCommand(const std::string& line) {
+    std::istringstream args(line);
+    std::string cmd;
+    args >> cmd;
+
+    if (cmd == "uci") cmdUci();
+    else if (cmd == "isready") send("readyok");
+    else if (cmd == "ucinewgame") {
+        stopSearch();
+        engine.clearHash();
+    }
+    else if (cmd == "setoption") cmdSetOption(args);
+    else if (cmd == "position") cmdPosition(args);
+    else if (cmd == "go") cmdGo(args);
+    else if (cmd == "stop") cmdStop();
+    else if (cmd == "ponderhit") cmdPonderhit();
+    else if (cmd == "quit") return false;
+    else if (!cmd.empty()) send("info string unknown command " + cmd);
+
+    return true;
+}
+
+void UciEngine::cmdUci() {
+    send("id name ChessMoveGen");
+    send("id author ChessMoveGen authors");
+    send("option name Hash type spin default 16 min 1 max " + std::to_string(MAX_HASH_MB));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(Engine::MAX_THREADS));
+    send("option name Ponder type check default false");
+    send("option name EvalFile type string default <empty>");
+    send("option name OwnBook type check default false");
+    send("option name BookFile type string default <empty>");
+    send("option name TablebasePath type string default <empty>");
+    send("uciok");
+}
+
+void UciEngine::cmdSetOption(std::istringstream& args) {
+    // setoption name <id> [value <x>], the id may contain spaces
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    while (args >> token) {
+        value += (value.empty() ? "" : " ") + token;
+    }
+
+    // options can't change under a running search
+    stopSearch();
+
+    if (name == "Hash") {
+        int mb = std::atoi(value.c_str());
+        engine.setHashSize(mb > MAX_HASH_MB ? MAX_HASH_MB : mb);
+    }
+    else if (name == "Threads") {
+        engine.setThreads(std::atoi(value.c_str()));
+    }
+    else if (name == "Ponder") {
+        // nothing to do: pondering is driven by "go ponder"
+    }
+    else if (name == "EvalFile") {
+        if (value.empty() || value == "<empty>") {
+            Nnue::unload();
+            send("info string using the built-in evaluation");
+        }
+        else if (Nnue::load(value)) {
+            send("info string loaded network " + value + " (" + Nnue::kernelName() + ")");
+        }
+        else {
+            send("info string could not load network " + value + ", using the built-in evaluation");
+        }
+        Board.recomputeEval();
+    }
+    else if (name == "OwnBook") {
+        ownBook = value == "true";
+    }
+    else if (name == "BookFile") {
+        if (value.empty() || value == "<empty>") {
+            book.close();
+        }
+        else if (book.open(value)) {
+            send("info string loaded book " + value + " (" + std::to_string(book.size()) + " entries)");
+        }
+        else {
+            send("info string could not load book " + value);
+        }
+    }
+    else if (name == "TablebasePath") {
+        Tablebase::unload();
+        if (!value.empty() && value != "<empty>") {
+            int found = Tablebase::load(value);
+            send("info string loaded " + std::to_string(found) + " tablebases from " + value);
+        }
+    }
+    else {
+        send("info string unknown option " + name);
+    }
+}
+
+void UciEngine::cmdPosition(std::istringstream& args) {
+    std::string token, fen;
+    args >> token;
+
+    if (token == "startpos") {
+        fen = START_FEN;
+        args >> token;  // "moves", if any
+    }
+    else if (token == "fen") {
+        int fields = 0;
+        while (args >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+            ++fields;
+        }
+        // loadFEN needs the clocks, which many tools leave out
+        if (fields == 4) fen += " 0 1";
+        else if (fields == 5) fen += " 1";
+    }
+    else {
+        return;
+    }
+
+    stopSearch();
+
+    // moves are played on a copy, so a bad one leaves no half-built game
+    board position;
+    try {
+        position.loadFEN(fen);
+    }
+    catch (const std::exception&) {
+        send("info string invalid fen " + fen);
+        Board.loadFEN(START_FEN);
+        return;
+    }
+
+    while (args >> token) {
+        Move m;
+        if (!parseUciMove(position, moveGenerator, token, m)) {
+            send("info string illegal move " + token + ", position set to " + fen);
+            Board.loadFEN(fen);
+            return;
+        }
+        position.makeMove(m);
+    }
+    Board = position;
+}
+
+void UciEngine::cmdGo(std::istringstream& args) {
+    SearchLimits limits;
+    int wtime = 0, btime = 0, winc = 0, binc = 0, movesToGo = 0, mateMoves = 0;
+    bool infinite = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "depth") args >> limits.depth;
+        else if (token == "movetime") args >> limits.movetimeMs;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "wtime") args >> wtime;
+        else if (token == "btime") args >> btime;
+        else if (token == "winc") args >> winc;
+        else if (token == "binc") args >> binc;
+        else if (token == "movestogo") args >> movesToGo;
+        else if (token == "infinite") infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+        else if (token == "perft") {
+            int depth = 1;
+            args >> depth;
+            cmdPerft(depth);
+            return;
+        }
+        else if (token == "mate") args >> mateMoves;
+    }
+
+    if (mateMoves > 0) {
+        cmdMate(mateMoves, limits.nodes);
+        return;
+    }
+
+    // ---- Time budget from the clock ----
+    int time = Board.isWhiteTurn ? wtime : btime;
+    int inc = Board.isWhiteTurn ? winc : binc;
+    if (limits.movetimeMs == 0 && time > 0) {
+        int budget = time / (movesToGo > 0 ? movesToGo : DEFAULT_MOVES_TO_GO) + inc * 3 / 4;
+        int cap = time - MOVE_OVERHEAD_MS;
+        if (budget > cap) budget = cap;
+        limits.movetimeMs = budget > 1 ? budget : 1;
+    }
+    if (infinite) {
+        limits.depth = 0;
+        limits.movetimeMs = 0;
+        limits.nodes = 0;
+    }
+
+    stopSearch();
+
+    // a book move answers at once; infinite and ponder searches are left
+    // alone since the GUI expects them to run until told otherwise
+    Move bookMove;
+    if (ownBook && !infinite && !limits.ponder && book.pickMove(Board, moveGenerator, bookMove)) {
+        send("info string book move");
+        send("bestmove " + moveToUci(bookMove));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(holdMutex);
+        holdBestMove = infinite || limits.ponder;
+    }
+    stopRequested.store(false);
+
+    board root = Board;
+    searchThread = std::thread([this, root, limits]() mutable {
+        Instrument::reset();
+        engine.setInfoCallback([this, &root](const SearchStats& s) {
+            // a "stop" that came in before go() reset the stop flag
+            if (stopRequested.load()) engine.stop();
+            reportIteration(root, s);
+        });
+
+        Move best = engine.go(root, limits);
+        std::vector<Move> pv = engine.principalVariation(root, 2);
+
+        {
+            std::unique_lock<std::mutex> lock(holdMutex);
+            holdReleased.wait(lock, [this]() { return !holdBestMove; });
+        }
+
+        std::string reply = "bestmove " + moveToUci(best);
+        if (pv.size() >= 2 && pv[0].from == best.from && pv[0].to == best.to) {
+            reply += " ponder " + moveToUci(pv[1]);
+        }
+        reportCounters();
+        send(reply);
+    });
+}
+
+void UciEngine::cmdPerft(int depth) {
+    stopSearch();
+
+    board root = Board;
+    searchThread = std::thread([this, root, depth]() mutable {
+        MoveGenerator generator;
+        Instrument::reset();
+        auto start = std::chrono::steady_clock::now();
+
+        long long total = 0;
+        for (const auto& entry : perftDivide(generator, root, depth)) {
+            send(moveToUci(entry.first) + ": " + std::to_string(entry.second));
+            total += entry.second;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        send("");
+        send("Nodes searched: " + std::to_string(total));
+        send("info string perft " + std::to_string(depth) + " time "
+            + std::to_string((long long)(seconds * 1000)) + " ms");
+        reportCounters();
+    });
+}
+
+// "go mate <moves>": proof-number search instead of the engine. Answers
+// with the mating move, or 0000 if there is no mate in that many moves.
+void UciEngine::cmdMate(int moves, long long maxNodes) {
+    stopSearch();
+    if (!mateSolver) mateSolver.reset(new MateSolver(MATE_SOLVER_MB));
+
+    board root = Board;
+    searchThread = std::thread([this, root, moves, maxNodes]() {
+        MateResult r = mateSolver->solve(root, moves, false, maxNodes);
+
+        long long ms = (long long)(r.seconds * 1000);
+        long long nps = r.seconds > 0.0 ? (long long)(r.nodes / r.seconds) : 0;
+        std::string stats = " nodes " + std::to_string(r.nodes) + " nps " + std::to_string(nps)
+            + " time " + std::to_string(ms);
+
+        if (r.status == MateResult::MATE && !r.line.empty()) {
+            std::string pv;
+            for (const Move& m : r.line) pv += " " + moveToUci(m);
+            send("info depth " + std::to_string(r.plies) + " score mate " + std::to_string((r.plies + 1) / 2)
+                + stats + " pv" + pv);
+            send("bestmove " + moveToUci(r.line[0]));
+        }
+        else {
+            send("info string " + std::string(r.status == MateResult::NO_MATE ? "no mate" : "no mate found")
+                + " in " + std::to_string(moves) + stats);
+            send("bestmove 0000");
+        }
+    });
+}
+
+void UciEngine::cmdStop() {
+    stopRequested.store(true);
+    engine.stop();
+    if (mateSolver) mateSolver->stop();
+    releaseBestMove();
+}
+
+void UciEngine::cmdPonderhit() {
+    // the opponent played the expected move: the clock now runs for us
+    engine.ponderhit();
+    releaseBestMove();
+}
+
+void UciEngine::releaseBestMove() {
+    {
+        std::lock_guard<std::mutex> lock(holdMutex);
+        holdBestMove = false;
+    }
+    holdReleased.notify_all();
+}
+
+void UciEngine::waitForSearch() {
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+}
+
+void UciEngine::stopSearch() {
+    cmdStop();
+    waitForSearch();
+}
+
+void UciEngine::reportIteration(const board& root, const SearchStats& s) {
+    std::string score;
+    if (s.score > Engine::MATE_BOUND) {
+        score = "mate " + std::to_string((Engine::MATE - s.score + 1) / 2);
+    }
+    else if (s.score < -Engine::MATE_BOUND) {
+        score = "mate -" + std::to_string((Engine::MATE + s.score) / 2);
+    }
+    else {
+        score = "cp " + std::to_string(s.score);
+    }
+
+    long long ms = (long long)(s.seconds * 1000);
+    long long nps = s.seconds > 0.0 ? (long long)(s.nodes / s.seconds) : 0;
+
+    std::string line = "info depth " + std::to_string(s.depth)
+        + " score " + score
+        + " nodes " + std::to_string(s.nodes)
+        + " nps " + std::to_string(nps)
+        + " time " + std::to_string(ms)
+        + " hashfull " + std::to_string(engine.hashfull())
+        + " pv";
+    for (const Move& m : engine.principalVariation(root)) {
+        line += " " + moveToUci(m);
+    }
+    send(line);
+}
+
+void UciEngine::reportCounters() {
+    // only builds with MOVEGEN_INSTRUMENT have anything to report
+    if (Instrument::enabled()) {
+        send("info string counters " + Instrument::toJson(Instrument::aggregate()));
+    }
+}
+
+void UciEngine::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
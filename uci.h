@@ -0,0 +1,74 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <atomic>
+#include <condition_variable>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "board.h"
+#include "movegenerator.h"
+#include "engine.h"
+#include "openingbook.h"
+#include "matesolver.h"
+
+// Console front end speaking the UCI protocol. Commands are read on the
+// calling thread and searches run on a thread of their own, so "stop" and
+// "ponderhit" are handled while the engine is thinking.
+class UciEngine
+{
+public:
+    UciEngine();
+    ~UciEngine();
+
+    // Reads commands until "quit" or end of input.
+    void loop(std::istream& in);
+
+private:
+    // Returns false on "quit".
+    bool handleCommand(const std::string& line);
+
+    void cmdUci();
+    void cmdSetOption(std::istringstream& args);
+    void cmdPosition(std::istringstream& args);
+    void cmdGo(std::istringstream& args);
+    void cmdPerft(int depth);
+    void cmdMate(int moves, long long maxNodes);
+    void cmdStop();
+    void cmdPonderhit();
+
+    // Blocks until the current search thread, if any, has finished.
+    void waitForSearch();
+    // Stops the current search, then waits for it. Commands that replace
+    // the position, the options or the search use this: infinite and
+    // ponder searches never finish by themselves, and waiting for one would
+    // leave the "stop" and "quit" behind it unread.
+    void stopSearch();
+    void releaseBestMove();
+    void reportIteration(const board& root, const SearchStats& s);
+    void reportCounters();
+    void send(const std::string& line);
+
+    Engine engine;
+    board Board;
+    MoveGenerator moveGenerator;
+    OpeningBook book;
+    bool ownBook = false;
+    std::unique_ptr<MateSolver> mateSolver;     // allocated on the first "go mate"
+
+    std::thread searchThread;
+    std::mutex outputMutex;
+
+    // "go infinite" and "go ponder" must not answer before stop/ponderhit,
+    // even if the search itself ends early.
+    std::mutex holdMutex;
+    std::condition_variable holdReleased;
+    bool holdBestMove = false;
+    std::atomic<bool> stopRequested{ false };
+};
+
+#endif // UCI_H
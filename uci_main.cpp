@@ -0,0 +1,10 @@
+#include "uci.h"
+
+#include <iostream>
+
+int main()
+{
+    UciEngine uci;
+    uci.loop(std::cin);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include "zobrist.h"
+#include "board.h"
+
+uint64_t Zobrist::compute(const board& Board) {
+    uint64_t key = 0;
+
+    for (int sq = 0; sq < 64; ++sq) {
+        key ^= KEYS.piece[Board.currentState[sq]][sq];
+    }
+
+    key ^= KEYS.castle[Board.castleRights & 0b1111];
+
+    if (Board.hasEnPassant) {
+        key ^= KEYS.enPassant[Board.enPassantSquare];
+    }
+
+    if (!Board.isWhiteTurn) {
+        key ^= KEYS.side;
+    }
+
+    return key;
+}
@@ -0,0 +1,52 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+class board;
+
+namespace Zobrist {
+
+    // Random keys are generated at compile time from a fixed seed so that a
+    // position hashes to the same value in every run and on every thread.
+    struct Keys {
+        uint64_t piece[13][64];     // indexed by Piece; the EMPTY row stays zero
+        uint64_t castle[16];        // indexed by the full castleRights mask
+        uint64_t enPassant[64];     // only xored in while hasEnPassant is set
+        uint64_t side;              // xored in when black is to move
+
+        constexpr Keys() : piece(), castle(), enPassant(), side(0) {
+            uint64_t seed = 0x2545F4914F6CDD1DULL;
+
+            for (int p = 1; p < 13; ++p) {
+                for (int sq = 0; sq < 64; ++sq) {
+                    piece[p][sq] = next(seed);
+                }
+            }
+            for (int c = 0; c < 16; ++c) {
+                castle[c] = next(seed);
+            }
+            for (int sq = 0; sq < 64; ++sq) {
+                enPassant[sq] = next(seed);
+            }
+            side = next(seed);
+        }
+
+    private:
+        // splitmix64
+        static constexpr uint64_t next(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    inline constexpr Keys KEYS{};
+
+    // Full recomputation from the board, used after loadFEN/resetBoard.
+    // makeMove/unmakeMove keep board::zobristKey up to date incrementally.
+    uint64_t compute(const board& Board);
+}
+
+#endif // ZOBRIST_H